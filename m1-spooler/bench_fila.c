@@ -0,0 +1,451 @@
+#include "fila.h"
+#include <semaphore.h>
+#include <sys/resource.h>
+
+// Microbenchmark da FilaImpressao: N produtores e M consumidores trocando
+// trabalhos direto pela fila, sem pipe, socket nem log, para cada capacidade
+// e implementação pedidas
+
+#define OPERACOES_PADRAO 1000000
+#define AMOSTRA_PADRAO 16       // Mede a latência de 1 operação em cada AMOSTRA_PADRAO
+#define MAX_LISTA 16            // Valores por opção de lista (--produtores 1,2,4 ...)
+
+// Uma implementação de fila sob teste; cada uma conta sua própria contenção
+typedef struct {
+    const char *nome;
+    void *(*criar)(int capacidade);
+    int (*enfileirar)(void *fila, const TrabalhoImpressao *trabalho);
+    int (*desenfileirar)(void *fila, TrabalhoImpressao *trabalho);
+    void (*contencao)(ContencaoFila *contencao);    // Da thread que chama
+    void (*destruir)(void *fila);
+} ImplementacaoFila;
+
+// Anel sem lock atual (fila.c)
+static void *criar_anel(int capacidade) {
+    return criar_fila(capacidade);
+}
+
+static int enfileirar_anel(void *fila, const TrabalhoImpressao *trabalho) {
+    return enfileirar_trabalho(fila, *trabalho);
+}
+
+static int desenfileirar_anel(void *fila, TrabalhoImpressao *trabalho) {
+    return desenfileirar_trabalho(fila, trabalho);
+}
+
+static void destruir_anel(void *fila) {
+    destruir_fila(fila);
+}
+
+// Lista ligada com mutex e dois semáforos, como a FilaImpressao original, para
+// comparação; a capacidade vem do parâmetro em vez de MAX_TRABALHOS
+typedef struct NoLista {
+    TrabalhoImpressao trabalho;
+    struct NoLista *proximo;
+} NoLista;
+
+typedef struct {
+    NoLista *inicio;
+    NoLista *fim;
+    int tamanho;
+    pthread_mutex_t mutex;
+    sem_t vazio;    // Trabalhos disponíveis
+    sem_t cheio;    // Espaços disponíveis
+} FilaLista;
+
+// Na lista, conflito é encontrar o mutex ocupado; espera é o semáforo em zero
+static __thread ContencaoFila contencao_lista;
+
+static void travar_lista(FilaLista *fila) {
+    if (pthread_mutex_trylock(&fila->mutex) != 0) {
+        contencao_lista.cas_falhos++;
+        pthread_mutex_lock(&fila->mutex);
+    }
+}
+
+static void esperar_semaforo(sem_t *semaforo, unsigned long long *esperas) {
+    if (sem_trywait(semaforo) != 0) {
+        (*esperas)++;
+        while (sem_wait(semaforo) != 0) {
+            // Interrompido por sinal: espera de novo
+        }
+    }
+}
+
+static void *criar_lista(int capacidade) {
+    FilaLista *fila = calloc(1, sizeof(FilaLista));
+    if (fila == NULL) return NULL;
+    
+    pthread_mutex_init(&fila->mutex, NULL);
+    sem_init(&fila->vazio, 0, 0);
+    sem_init(&fila->cheio, 0, capacidade);
+    return fila;
+}
+
+static int enfileirar_lista(void *dados, const TrabalhoImpressao *trabalho) {
+    FilaLista *fila = dados;
+    esperar_semaforo(&fila->cheio, &contencao_lista.esperas_cheia);
+    
+    NoLista *novo_no = malloc(sizeof(NoLista));
+    if (novo_no == NULL) {
+        sem_post(&fila->cheio);
+        return -1;
+    }
+    novo_no->trabalho = *trabalho;
+    novo_no->proximo = NULL;
+    
+    travar_lista(fila);
+    if (fila->fim == NULL) {
+        fila->inicio = novo_no;
+    } else {
+        fila->fim->proximo = novo_no;
+    }
+    fila->fim = novo_no;
+    fila->tamanho++;
+    pthread_mutex_unlock(&fila->mutex);
+    
+    sem_post(&fila->vazio);
+    return 0;
+}
+
+static int desenfileirar_lista(void *dados, TrabalhoImpressao *trabalho) {
+    FilaLista *fila = dados;
+    esperar_semaforo(&fila->vazio, &contencao_lista.esperas_vazia);
+    
+    travar_lista(fila);
+    NoLista *no_removido = fila->inicio;
+    fila->inicio = no_removido->proximo;
+    if (fila->inicio == NULL) {
+        fila->fim = NULL;
+    }
+    fila->tamanho--;
+    pthread_mutex_unlock(&fila->mutex);
+    
+    *trabalho = no_removido->trabalho;
+    free(no_removido);
+    sem_post(&fila->cheio);
+    return 0;
+}
+
+static void ler_contencao_lista(ContencaoFila *contencao) {
+    *contencao = contencao_lista;
+}
+
+static void destruir_lista(void *dados) {
+    FilaLista *fila = dados;
+    while (fila->inicio != NULL) {
+        NoLista *no = fila->inicio;
+        fila->inicio = no->proximo;
+        free(no);
+    }
+    pthread_mutex_destroy(&fila->mutex);
+    sem_destroy(&fila->vazio);
+    sem_destroy(&fila->cheio);
+    free(fila);
+}
+
+static const ImplementacaoFila implementacoes[] = {
+    { "anel", criar_anel, enfileirar_anel, desenfileirar_anel, ler_contencao_fila, destruir_anel },
+    { "lista", criar_lista, enfileirar_lista, desenfileirar_lista, ler_contencao_lista, destruir_lista },
+};
+#define NUM_IMPLEMENTACOES ((int)(sizeof(implementacoes) / sizeof(implementacoes[0])))
+
+// Estado de uma thread do benchmark; o histograma é só dela (sem disputa)
+typedef struct {
+    const ImplementacaoFila *implementacao;
+    void *fila;
+    pthread_barrier_t *partida;
+    int primeiro_id;            // Produtor: ids primeiro_id .. primeiro_id + operacoes - 1
+    int operacoes;
+    int amostra;
+    unsigned long long soma_ids;    // Consumidor: confere que cada trabalho chegou uma vez
+    unsigned long long retirados;
+    ContencaoFila contencao;
+    Histograma *latencia;       // ns por operação (amostrada)
+} ThreadBench;
+
+static void *thread_produtora(void *arg) {
+    ThreadBench *thread = arg;
+    TrabalhoImpressao trabalho;
+    memset(&trabalho, 0, sizeof(trabalho));
+    strcpy(trabalho.nome_arquivo, "bench.pdf");
+    trabalho.numero_paginas = 1;
+    
+    ContencaoFila antes;
+    thread->implementacao->contencao(&antes);
+    pthread_barrier_wait(thread->partida);
+    
+    for (int i = 0; i < thread->operacoes; i++) {
+        trabalho.id_job = thread->primeiro_id + i;
+        if (i % thread->amostra == 0) {
+            long long inicio = instante_ns();
+            thread->implementacao->enfileirar(thread->fila, &trabalho);
+            registrar_valor(thread->latencia, (unsigned long long)(instante_ns() - inicio));
+        } else {
+            thread->implementacao->enfileirar(thread->fila, &trabalho);
+        }
+    }
+    
+    thread->implementacao->contencao(&thread->contencao);
+    thread->contencao.cas_falhos -= antes.cas_falhos;
+    thread->contencao.esperas_cheia -= antes.esperas_cheia;
+    thread->contencao.esperas_vazia -= antes.esperas_vazia;
+    return NULL;
+}
+
+// Consome até receber um trabalho com id -1 (um por consumidor, no final)
+static void *thread_consumidora(void *arg) {
+    ThreadBench *thread = arg;
+    TrabalhoImpressao trabalho;
+    
+    ContencaoFila antes;
+    thread->implementacao->contencao(&antes);
+    pthread_barrier_wait(thread->partida);
+    
+    for (unsigned long long i = 0;; i++) {
+        if (i % thread->amostra == 0) {
+            long long inicio = instante_ns();
+            thread->implementacao->desenfileirar(thread->fila, &trabalho);
+            registrar_valor(thread->latencia, (unsigned long long)(instante_ns() - inicio));
+        } else {
+            thread->implementacao->desenfileirar(thread->fila, &trabalho);
+        }
+        if (trabalho.id_job < 0) break;
+        thread->soma_ids += (unsigned long long)trabalho.id_job;
+        thread->retirados++;
+    }
+    
+    thread->implementacao->contencao(&thread->contencao);
+    thread->contencao.cas_falhos -= antes.cas_falhos;
+    thread->contencao.esperas_cheia -= antes.esperas_cheia;
+    thread->contencao.esperas_vazia -= antes.esperas_vazia;
+    return NULL;
+}
+
+static void somar_histograma(Histograma *destino, const Histograma *origem) {
+    destino->total += origem->total;
+    destino->soma += origem->soma;
+    if (origem->maximo > destino->maximo) destino->maximo = origem->maximo;
+    for (int i = 0; i < HISTOGRAMA_BUCKETS; i++) {
+        destino->contagens[i] += origem->contagens[i];
+    }
+}
+
+static long long tempo_cpu_ns(const struct rusage *uso) {
+    return (uso->ru_utime.tv_sec + uso->ru_stime.tv_sec) * 1000000000LL +
+           (uso->ru_utime.tv_usec + uso->ru_stime.tv_usec) * 1000LL;
+}
+
+// Uma rodada: operacoes trabalhos de produtores para consumidores. Retorna -1
+// se faltou memória ou algum trabalho se perdeu/duplicou.
+static int executar_rodada(const ImplementacaoFila *implementacao, int produtores, int consumidores,
+                           int capacidade, int operacoes, int amostra) {
+    int num_threads = produtores + consumidores;
+    ThreadBench *threads = calloc(num_threads, sizeof(ThreadBench));
+    pthread_t *ids = calloc(num_threads, sizeof(pthread_t));
+    Histograma *enfileirar = calloc(1, sizeof(Histograma));
+    Histograma *desenfileirar = calloc(1, sizeof(Histograma));
+    void *fila = implementacao->criar(capacidade);
+    int resultado = -1;
+    
+    if (threads == NULL || ids == NULL || enfileirar == NULL || desenfileirar == NULL || fila == NULL) {
+        fprintf(stderr, "Memória insuficiente para a rodada\n");
+        goto liberar;
+    }
+    
+    pthread_barrier_t partida;
+    pthread_barrier_init(&partida, NULL, num_threads + 1);
+    
+    int criadas = 0;
+    int proximo_id = 0;
+    for (int i = 0; i < num_threads; i++) {
+        ThreadBench *thread = &threads[i];
+        thread->implementacao = implementacao;
+        thread->fila = fila;
+        thread->partida = &partida;
+        thread->amostra = amostra;
+        thread->latencia = calloc(1, sizeof(Histograma));
+        if (thread->latencia == NULL) break;
+        
+        int produtora = i < produtores;
+        if (produtora) {
+            thread->operacoes = operacoes / produtores + (i < operacoes % produtores);
+            thread->primeiro_id = proximo_id;
+            proximo_id += thread->operacoes;
+        }
+        if (pthread_create(&ids[i], NULL, produtora ? thread_produtora : thread_consumidora, thread) != 0) {
+            free(thread->latencia);
+            thread->latencia = NULL;
+            break;
+        }
+        criadas++;
+    }
+    if (criadas < num_threads) {
+        // Sem todas as threads a barreira nunca abre: a rodada não tem como seguir
+        fprintf(stderr, "Erro ao criar as threads da rodada\n");
+        exit(1);
+    }
+    
+    struct rusage uso_antes, uso_depois;
+    getrusage(RUSAGE_SELF, &uso_antes);
+    pthread_barrier_wait(&partida);
+    long long inicio_ns = instante_ns();
+    
+    for (int i = 0; i < produtores; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    
+    // Um marcador de fim por consumidor
+    TrabalhoImpressao fim;
+    memset(&fim, 0, sizeof(fim));
+    fim.id_job = -1;
+    for (int i = 0; i < consumidores; i++) {
+        implementacao->enfileirar(fila, &fim);
+    }
+    for (int i = produtores; i < num_threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    
+    long long duracao_ns = instante_ns() - inicio_ns;
+    getrusage(RUSAGE_SELF, &uso_depois);
+    pthread_barrier_destroy(&partida);
+    
+    // Soma os histogramas, a contenção e a conferência
+    ContencaoFila contencao = { 0, 0, 0 };
+    unsigned long long soma_ids = 0, retirados = 0;
+    for (int i = 0; i < num_threads; i++) {
+        somar_histograma(i < produtores ? enfileirar : desenfileirar, threads[i].latencia);
+        contencao.cas_falhos += threads[i].contencao.cas_falhos;
+        contencao.esperas_cheia += threads[i].contencao.esperas_cheia;
+        contencao.esperas_vazia += threads[i].contencao.esperas_vazia;
+        soma_ids += threads[i].soma_ids;
+        retirados += threads[i].retirados;
+    }
+    unsigned long long esperada = (unsigned long long)operacoes * (operacoes - 1) / 2;
+    
+    ResumoHistograma r_enf, r_des;
+    resumir_histograma(enfileirar, &r_enf);
+    resumir_histograma(desenfileirar, &r_des);
+    double ops_s = operacoes / (duracao_ns / 1e9);
+    double trocas = (double)(uso_depois.ru_nvcsw - uso_antes.ru_nvcsw) +
+                    (double)(uso_depois.ru_nivcsw - uso_antes.ru_nivcsw);
+    
+    printf("%-6s %4d %4d %7d %11.0f %7llu %7llu %8llu %7llu %7llu %8llu %7.3f %7.3f %7.3f %7.3f %7.0f\n",
+           implementacao->nome, produtores, consumidores, capacidade, ops_s,
+           r_enf.p50, r_enf.p99, r_enf.p999, r_des.p50, r_des.p99, r_des.p999,
+           (double)contencao.cas_falhos / operacoes, (double)contencao.esperas_cheia / operacoes,
+           (double)contencao.esperas_vazia / operacoes, trocas / operacoes,
+           (double)(tempo_cpu_ns(&uso_depois) - tempo_cpu_ns(&uso_antes)) / operacoes);
+    fflush(stdout);
+    
+    if (retirados != (unsigned long long)operacoes || soma_ids != esperada) {
+        fprintf(stderr, "%s: %llu trabalhos retirados de %d (soma dos ids %llu, esperada %llu)\n",
+                implementacao->nome, retirados, operacoes, soma_ids, esperada);
+    } else {
+        resultado = 0;
+    }
+
+liberar:
+    if (threads != NULL) {
+        for (int i = 0; i < num_threads; i++) free(threads[i].latencia);
+    }
+    if (fila != NULL) implementacao->destruir(fila);
+    free(threads);
+    free(ids);
+    free(enfileirar);
+    free(desenfileirar);
+    return resultado;
+}
+
+// Lê "1,2,4" em valores; retorna quantos leu, ou -1 se algum não é positivo
+static int ler_lista(const char *texto, int *valores) {
+    int quantidade = 0;
+    while (*texto != '\0' && quantidade < MAX_LISTA) {
+        char *fim;
+        long valor = strtol(texto, &fim, 10);
+        if (fim == texto || valor < 1 || valor > 1 << 24 || (*fim != ',' && *fim != '\0')) return -1;
+        valores[quantidade++] = (int)valor;
+        texto = *fim == ',' ? fim + 1 : fim;
+    }
+    return *texto == '\0' && quantidade > 0 ? quantidade : -1;
+}
+
+static void exibir_uso(const char *programa) {
+    printf("Uso: %s [opções]\n", programa);
+    printf("  --produtores N,...     Threads produtoras (padrão 1,4)\n");
+    printf("  --consumidores M,...   Threads consumidoras (padrão 1,4)\n");
+    printf("  --capacidades C,...    Capacidades da fila (padrão 16,256,4096)\n");
+    printf("  --operacoes K          Trabalhos por rodada (padrão %d)\n", OPERACOES_PADRAO);
+    printf("  --amostra S            Mede a latência de 1 operação em cada S (padrão %d)\n", AMOSTRA_PADRAO);
+    printf("  --implementacoes I,... anel, lista ou ambas (padrão anel,lista)\n");
+}
+
+int main(int argc, char *argv[]) {
+    int produtores[MAX_LISTA] = { 1, 4 }, num_produtores = 2;
+    int consumidores[MAX_LISTA] = { 1, 4 }, num_consumidores = 2;
+    int capacidades[MAX_LISTA] = { 16, 256, 4096 }, num_capacidades = 3;
+    int operacoes = OPERACOES_PADRAO;
+    int amostra = AMOSTRA_PADRAO;
+    int escolhidas[NUM_IMPLEMENTACOES];
+    int num_escolhidas = NUM_IMPLEMENTACOES;
+    for (int i = 0; i < NUM_IMPLEMENTACOES; i++) escolhidas[i] = i;
+    
+    for (int i = 1; i < argc; i++) {
+        int invalida = 0;
+        if (strcmp(argv[i], "--produtores") == 0 && i + 1 < argc) {
+            invalida = (num_produtores = ler_lista(argv[++i], produtores)) < 0;
+        } else if (strcmp(argv[i], "--consumidores") == 0 && i + 1 < argc) {
+            invalida = (num_consumidores = ler_lista(argv[++i], consumidores)) < 0;
+        } else if (strcmp(argv[i], "--capacidades") == 0 && i + 1 < argc) {
+            invalida = (num_capacidades = ler_lista(argv[++i], capacidades)) < 0;
+        } else if (strcmp(argv[i], "--operacoes") == 0 && i + 1 < argc) {
+            operacoes = atoi(argv[++i]);
+            invalida = operacoes < 1;
+        } else if (strcmp(argv[i], "--amostra") == 0 && i + 1 < argc) {
+            amostra = atoi(argv[++i]);
+            invalida = amostra < 1;
+        } else if (strcmp(argv[i], "--implementacoes") == 0 && i + 1 < argc) {
+            char nomes[256];
+            snprintf(nomes, sizeof(nomes), "%s", argv[++i]);
+            num_escolhidas = 0;
+            for (char *nome = strtok(nomes, ","); nome != NULL && !invalida; nome = strtok(NULL, ",")) {
+                int encontrada = -1;
+                for (int j = 0; j < NUM_IMPLEMENTACOES; j++) {
+                    if (strcmp(nome, implementacoes[j].nome) == 0) encontrada = j;
+                }
+                invalida = encontrada < 0 || num_escolhidas == NUM_IMPLEMENTACOES;
+                if (!invalida) escolhidas[num_escolhidas++] = encontrada;
+            }
+            invalida |= num_escolhidas == 0;
+        } else {
+            invalida = 1;
+        }
+        if (invalida) {
+            exibir_uso(argv[0]);
+            return 1;
+        }
+    }
+    
+    printf("Benchmark da fila: %d trabalhos por rodada, latência de 1 em %d operações (ns)\n",
+           operacoes, amostra);
+    printf("conflitos, esperas e trocas de contexto por trabalho; cpu em ns por trabalho\n");
+    printf("%-6s %4s %4s %7s %11s %7s %7s %8s %7s %7s %8s %7s %7s %7s %7s %7s\n",
+           "impl", "prod", "cons", "capac", "ops/s", "enf50", "enf99", "enf99.9", "des50", "des99", "des99.9",
+           "confl", "cheia", "vazia", "trocas", "cpu");
+    
+    int falhas = 0;
+    for (int p = 0; p < num_produtores; p++) {
+        for (int c = 0; c < num_consumidores; c++) {
+            for (int k = 0; k < num_capacidades; k++) {
+                for (int m = 0; m < num_escolhidas; m++) {
+                    if (executar_rodada(&implementacoes[escolhidas[m]], produtores[p], consumidores[c],
+                                        capacidades[k], operacoes, amostra) != 0) {
+                        falhas++;
+                    }
+                }
+            }
+        }
+    }
+    
+    return falhas == 0 ? 0 : 1;
+}
@@ -0,0 +1,402 @@
+#include "envio.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#define ARQUIVO_RESULTADOS "resultados_carga.txt"
+#define CARGA_LOTE_MAXIMO 256                   // Trabalhos atrasados enviados de uma vez (malha aberta)
+#define CARGA_AGENDA (2 * JANELA_CONFIRMACOES)  // Instantes de envio sem confirmação, por thread
+#define CARGA_PARTIDA_MS 200                    // Folga para todos conectarem antes da partida comum
+#define CARGA_ESPERA_PADRAO_S 60                // Espera máxima pelas impressões ao final
+
+// Malha aberta: chegadas a taxa fixa, independentes das respostas do servidor.
+// Malha fechada: cada thread mantém janela trabalhos sem confirmação e só envia
+// o próximo quando um é confirmado.
+typedef enum { MALHA_ABERTA, MALHA_FECHADA } ModoCarga;
+
+// Resultado comum a todos os processos e threads: fica num mmap anônimo
+// compartilhado antes do fork e só é atualizado com atômicos
+typedef struct {
+    long long partida_ns;           // Instante comum de início (relógio monotônico)
+    long long ultimo_envio_ns;
+    unsigned long long enviados;
+    unsigned long long aceitos;
+    unsigned long long recusados;
+    unsigned long long falhas;      // Threads que perderam a conexão
+    Histograma latencia;            // Envio agendado -> confirmação (µs)
+} ResultadoCarga;
+
+// Estado de uma thread: a conexão e os instantes de envio ainda sem confirmação,
+// na ordem em que as confirmações chegam
+typedef struct {
+    ConexaoCliente conexao;
+    GeradorTrabalhos gerador;
+    long long agenda[CARGA_AGENDA];
+    unsigned long long agendados;
+    unsigned long long confirmados;
+} ThreadCarga;
+
+static ModoCarga modo = MALHA_FECHADA;
+static double taxa_por_thread = 0;
+static int janela = 1;
+static double duracao_s = 5;
+static GeradorTrabalhos gerador_base;
+static ResultadoCarga *resultado;
+
+// Latência de cada confirmação, contada do instante em que o trabalho devia
+// sair: na malha aberta, um servidor lento não esconde a fila que formou
+// (sem omissão coordenada)
+static void registrar_confirmacao(void *contexto, const ConfirmacaoTrabalho *confirmacao) {
+    ThreadCarga *thread = contexto;
+    (void)confirmacao;
+    
+    long long envio_ns = thread->agenda[thread->confirmados++ % CARGA_AGENDA];
+    long long latencia_ns = instante_ns() - envio_ns;
+    registrar_valor(&resultado->latencia, latencia_ns > 0 ? (unsigned long long)latencia_ns / 1000 : 0);
+}
+
+static void agendar(ThreadCarga *thread, long long envio_ns) {
+    thread->agenda[thread->agendados++ % CARGA_AGENDA] = envio_ns;
+}
+
+// Lê as confirmações que chegarem até prazo_ns sem bloquear além dele
+static int receber_ate(ConexaoCliente *conexao, long long prazo_ns) {
+    for (;;) {
+        long long restante_ns = prazo_ns - instante_ns();
+        if (restante_ns <= 0) return 0;
+        
+        struct pollfd leitura = { .fd = conexao->socket_fd, .events = POLLIN };
+        int espera_ms = (int)(restante_ns / 1000000);
+        int prontos = poll(&leitura, 1, espera_ms);
+        if (prontos == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (prontos == 0) {
+            // Menos de 1 ms até o prazo: o poll não espera frações de milissegundo
+            if (espera_ms == 0) esperar_ate(prazo_ns / 1e9);
+            continue;
+        }
+        
+        int disponiveis = 0;
+        if (!(leitura.revents & POLLIN) || ioctl(conexao->socket_fd, FIONREAD, &disponiveis) == -1 ||
+            disponiveis == 0) {
+            return -1;      // Servidor fechou a conexão
+        }
+        
+        // Só as confirmações inteiras já disponíveis: receber_confirmacoes não bloqueia
+        int completas = (int)((conexao->bytes_recebidos + disponiveis) / sizeof(ConfirmacaoTrabalho));
+        if (completas > conexao->em_transito) completas = conexao->em_transito;
+        if (completas > 0 && receber_confirmacoes(conexao, conexao->em_transito - completas) != 0) {
+            return -1;
+        }
+    }
+}
+
+static unsigned long long enviar_malha_aberta(ThreadCarga *thread, long long fim_ns) {
+    TrabalhoImpressao lote[CARGA_LOTE_MAXIMO];
+    double intervalo_ns = 1e9 / taxa_por_thread;
+    unsigned long long enviados = 0;
+    
+    for (;;) {
+        long long proximo_ns = resultado->partida_ns + (long long)(enviados * intervalo_ns);
+        if (proximo_ns >= fim_ns) break;
+        if (receber_ate(&thread->conexao, proximo_ns) != 0) return enviados;
+        
+        // Tudo o que já devia ter saído vai num lote só
+        long long agora = instante_ns();
+        int quantidade = 0;
+        while (quantidade < CARGA_LOTE_MAXIMO && proximo_ns <= agora && proximo_ns < fim_ns) {
+            lote[quantidade++] = gerar_trabalho_impressao(&thread->gerador);
+            agendar(thread, proximo_ns);
+            proximo_ns = resultado->partida_ns + (long long)((enviados + quantidade) * intervalo_ns);
+        }
+        if (enviar_via_socket(&thread->conexao, lote, quantidade) != 0) return enviados;
+        enviados += quantidade;
+    }
+    return enviados;
+}
+
+static unsigned long long enviar_malha_fechada(ThreadCarga *thread, long long fim_ns) {
+    unsigned long long enviados = 0;
+    
+    while (instante_ns() < fim_ns) {
+        if (receber_confirmacoes(&thread->conexao, janela - 1) != 0) break;
+        
+        TrabalhoImpressao trabalho = gerar_trabalho_impressao(&thread->gerador);
+        agendar(thread, instante_ns());
+        if (enviar_via_socket(&thread->conexao, &trabalho, 1) != 0) break;
+        enviados++;
+    }
+    return enviados;
+}
+
+static void *thread_carga(void *arg) {
+    ThreadCarga *thread = arg;
+    
+    conectar(&thread->conexao, CANAL_SOCKET);
+    if (thread->conexao.socket_fd == -1) {
+        fprintf(stderr, "Gerador de carga: servidor não aceita conexões em %s\n", NOME_SOCKET);
+        __atomic_fetch_add(&resultado->falhas, 1, __ATOMIC_RELAXED);
+        desconectar(&thread->conexao);
+        return NULL;
+    }
+    thread->conexao.ao_confirmar = registrar_confirmacao;
+    thread->conexao.contexto = thread;
+    
+    // Todas as threads de todos os processos partem juntas
+    esperar_ate(resultado->partida_ns / 1e9);
+    long long fim_ns = resultado->partida_ns + (long long)(duracao_s * 1e9);
+    
+    unsigned long long enviados = modo == MALHA_ABERTA ? enviar_malha_aberta(thread, fim_ns)
+                                                       : enviar_malha_fechada(thread, fim_ns);
+    long long ultimo_envio_ns = instante_ns();
+    
+    // Espera a confirmação do que ainda está em trânsito
+    if (receber_confirmacoes(&thread->conexao, 0) != 0) {
+        __atomic_fetch_add(&resultado->falhas, 1, __ATOMIC_RELAXED);
+    }
+    desconectar(&thread->conexao);
+    
+    __atomic_fetch_add(&resultado->enviados, enviados, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&resultado->aceitos, (unsigned long long)thread->conexao.aceitos, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&resultado->recusados, (unsigned long long)thread->conexao.recusados,
+                       __ATOMIC_RELAXED);
+    long long anterior = __atomic_load_n(&resultado->ultimo_envio_ns, __ATOMIC_RELAXED);
+    while (ultimo_envio_ns > anterior &&
+           !__atomic_compare_exchange_n(&resultado->ultimo_envio_ns, &anterior, ultimo_envio_ns, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return NULL;
+}
+
+// Um processo gerador: num_threads conexões, cada uma com seu gerador de trabalhos
+static int executar_processo(int indice, int num_threads) {
+    ThreadCarga *threads = calloc(num_threads, sizeof(ThreadCarga));
+    pthread_t *ids = calloc(num_threads, sizeof(pthread_t));
+    if (threads == NULL || ids == NULL) {
+        perror("Erro ao alocar threads do gerador");
+        return 1;
+    }
+    
+    int criadas = 0;
+    for (int i = 0; i < num_threads; i++) {
+        threads[i].gerador = gerador_base;
+        threads[i].gerador.semente = (unsigned int)(time(NULL) + getpid() * 131 + (indice * num_threads + i) * 7919);
+        if (pthread_create(&ids[criadas], NULL, thread_carga, &threads[i]) != 0) {
+            perror("Erro ao criar thread do gerador");
+            __atomic_fetch_add(&resultado->falhas, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        criadas++;
+    }
+    for (int i = 0; i < criadas; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    
+    free(threads);
+    free(ids);
+    return 0;
+}
+
+// Trabalhos impressos segundo o retrato de métricas do servidor; -1 se não há retrato
+static long long ler_impressos(const char *arquivo_metricas) {
+    FILE *arquivo = fopen(arquivo_metricas, "r");
+    if (arquivo == NULL) return -1;
+    
+    char linha[512];
+    long long impressos = -1;
+    while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+        unsigned long long recebidos, recusados, valor;
+        if (sscanf(linha, "Trabalhos: %llu recebidos, %llu recusados, %llu impressos",
+                   &recebidos, &recusados, &valor) == 3) {
+            impressos = (long long)valor;
+            break;
+        }
+    }
+    fclose(arquivo);
+    return impressos;
+}
+
+// Espera o servidor imprimir os aceitos desta execução; devolve o instante
+// em que o último retrato mostrou a contagem (ou o fim da espera)
+static long long aguardar_impressoes(const char *arquivo_metricas, long long base, long long *impressos,
+                                     int espera_s) {
+    long long limite_ns = instante_ns() + espera_s * 1000000000LL;
+    long long alvo = base + (long long)resultado->aceitos;
+    
+    for (;;) {
+        long long lidos = ler_impressos(arquivo_metricas);
+        if (lidos >= 0) *impressos = lidos;
+        long long agora = instante_ns();
+        if (*impressos >= alvo || agora >= limite_ns) return agora;
+        esperar_ate((agora + 10000000LL) / 1e9);
+    }
+}
+
+static void exibir_uso(const char *programa) {
+    printf("Uso: %s [opções]\n", programa);
+    printf("  --processos N     Processos geradores (padrão 1)\n");
+    printf("  --threads N       Threads por processo, uma conexão cada (padrão 4)\n");
+    printf("  --duracao S       Segundos de envio (padrão 5)\n");
+    printf("  --taxa R          Malha aberta: R trabalhos/s no total, a intervalos fixos\n");
+    printf("  --janela N        Malha fechada (padrão): N trabalhos sem confirmação por thread (padrão 1)\n");
+    printf("  --paginas D       uniforme:MIN:MAX (padrão 1:10), fixa:N, geometrica:MEDIA[:MAX] ou\n");
+    printf("                    bimodal:PEQUENO:GRANDE:FRACAO\n");
+    printf("  --prioridade P    0 (alta), 1 (normal, padrão), 2 (baixa) ou mista\n");
+    printf("  --metricas ARQ    Retrato de métricas do servidor, para contar os impressos (padrão %s)\n",
+           ARQUIVO_METRICAS);
+    printf("  --espera S        Espera máxima pelas impressões ao final (padrão %d; 0 não espera)\n",
+           CARGA_ESPERA_PADRAO_S);
+    printf("  --resultados ARQ  Arquivo onde cada execução acrescenta uma linha (padrão %s)\n",
+           ARQUIVO_RESULTADOS);
+    printf("  --rotulo R        Nome da execução na linha de resultados\n");
+}
+
+int main(int argc, char *argv[]) {
+    int num_processos = 1;
+    int num_threads = 4;
+    double taxa = 0;
+    int espera_s = CARGA_ESPERA_PADRAO_S;
+    const char *arquivo_metricas = ARQUIVO_METRICAS;
+    const char *arquivo_resultados = ARQUIVO_RESULTADOS;
+    const char *descricao_paginas = "uniforme:1:10";
+    const char *rotulo = "-";
+    int invalida = 0;
+    
+    inicializar_gerador(&gerador_base, 0);
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--processos") == 0 && i + 1 < argc) {
+            num_processos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duracao") == 0 && i + 1 < argc) {
+            duracao_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--taxa") == 0 && i + 1 < argc) {
+            taxa = atof(argv[++i]);
+            modo = MALHA_ABERTA;
+            invalida |= taxa <= 0;
+        } else if (strcmp(argv[i], "--janela") == 0 && i + 1 < argc) {
+            janela = atoi(argv[++i]);
+            modo = MALHA_FECHADA;
+        } else if (strcmp(argv[i], "--paginas") == 0 && i + 1 < argc) {
+            descricao_paginas = argv[++i];
+            invalida |= configurar_paginas(&gerador_base, descricao_paginas) != 0;
+        } else if (strcmp(argv[i], "--prioridade") == 0 && i + 1 < argc) {
+            const char *valor = argv[++i];
+            if (strcmp(valor, "mista") == 0) {
+                gerador_base.prioridade = -1;
+            } else if (valor[0] >= '0' && valor[0] <= '9' && atoi(valor) < NUM_PRIORIDADES) {
+                gerador_base.prioridade = atoi(valor);
+            } else {
+                invalida = 1;
+            }
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            arquivo_metricas = argv[++i];
+        } else if (strcmp(argv[i], "--espera") == 0 && i + 1 < argc) {
+            espera_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--resultados") == 0 && i + 1 < argc) {
+            arquivo_resultados = argv[++i];
+        } else if (strcmp(argv[i], "--rotulo") == 0 && i + 1 < argc) {
+            rotulo = argv[++i];
+        } else {
+            invalida = 1;
+        }
+    }
+    if (invalida || num_processos < 1 || num_threads < 1 || duracao_s <= 0 || espera_s < 0 ||
+        janela < 1 || janela > JANELA_CONFIRMACOES) {
+        exibir_uso(argv[0]);
+        return 1;
+    }
+    taxa_por_thread = taxa / (num_processos * num_threads);
+    
+    // Servidor fechou a conexão: erro de escrita em vez de encerrar o processo
+    signal(SIGPIPE, SIG_IGN);
+    
+    resultado = mmap(NULL, sizeof(ResultadoCarga), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (resultado == MAP_FAILED) {
+        perror("Erro ao mapear resultados");
+        return 1;
+    }
+    
+    long long impressos_base = ler_impressos(arquivo_metricas);
+    resultado->partida_ns = instante_ns() + CARGA_PARTIDA_MS * 1000000LL;
+    
+    if (modo == MALHA_ABERTA) {
+        printf("Gerador de carga: malha aberta, %.0f trabalhos/s, %d processos x %d threads, %.1f s, páginas %s\n",
+               taxa, num_processos, num_threads, duracao_s, descricao_paginas);
+    } else {
+        printf("Gerador de carga: malha fechada, janela %d, %d processos x %d threads, %.1f s, páginas %s\n",
+               janela, num_processos, num_threads, duracao_s, descricao_paginas);
+    }
+    fflush(stdout);
+    
+    // Processos geradores (o fork vem antes de qualquer thread)
+    int criados = 0;
+    for (int p = 0; p < num_processos; p++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Erro ao criar processo gerador");
+            break;
+        }
+        if (pid == 0) {
+            _exit(executar_processo(p, num_threads));
+        }
+        criados++;
+    }
+    for (int p = 0; p < criados; p++) {
+        wait(NULL);
+    }
+    
+    double envio_s = (resultado->ultimo_envio_ns - resultado->partida_ns) / 1e9;
+    double enviados_s = envio_s > 0 ? resultado->enviados / envio_s : 0;
+    
+    // Vazão de impressão pelo retrato do servidor (só com --metricas-intervalo > 0)
+    double concluidos_s = -1;
+    long long impressos = impressos_base;
+    if (impressos_base >= 0 && espera_s > 0) {
+        long long fim_ns = aguardar_impressoes(arquivo_metricas, impressos_base, &impressos, espera_s);
+        double total_s = (fim_ns - resultado->partida_ns) / 1e9;
+        if (total_s > 0) concluidos_s = (impressos - impressos_base) / total_s;
+    }
+    
+    ResumoHistograma latencia;
+    resumir_histograma(&resultado->latencia, &latencia);
+    
+    printf("Enviados: %llu (%.0f/s), aceitos %llu, recusados %llu, conexões perdidas %llu\n",
+           resultado->enviados, enviados_s, resultado->aceitos, resultado->recusados, resultado->falhas);
+    if (concluidos_s >= 0) {
+        printf("Impressos: %lld (%.0f/s até o último retrato do servidor)\n", impressos - impressos_base,
+               concluidos_s);
+    } else {
+        printf("Impressos: sem retrato de métricas do servidor em %s\n", arquivo_metricas);
+    }
+    escrever_histograma(stdout, "Confirmação (ms)", &resultado->latencia, 1000.0, 3);
+    
+    // Uma linha por execução, para acompanhar regressões
+    FILE *arquivo = fopen(arquivo_resultados, "a");
+    if (arquivo == NULL) {
+        perror("Erro ao abrir arquivo de resultados");
+        return 1;
+    }
+    char data[32];
+    time_t agora = time(NULL);
+    strftime(data, sizeof(data), "%Y-%m-%dT%H:%M:%S", localtime(&agora));
+    fprintf(arquivo, "%s rotulo=%s modo=%s taxa=%.0f janela=%d processos=%d threads=%d duracao=%.1f paginas=%s "
+            "enviados=%llu aceitos=%llu recusados=%llu falhas=%llu enviados_s=%.0f concluidos_s=%.0f "
+            "lat_media_ms=%.3f lat_p50_ms=%.3f lat_p90_ms=%.3f lat_p99_ms=%.3f lat_p999_ms=%.3f lat_max_ms=%.3f\n",
+            data, rotulo, modo == MALHA_ABERTA ? "aberta" : "fechada", taxa,
+            modo == MALHA_FECHADA ? janela : 0, num_processos, num_threads, duracao_s, descricao_paginas,
+            resultado->enviados, resultado->aceitos, resultado->recusados, resultado->falhas, enviados_s,
+            concluidos_s, latencia.media / 1000.0, latencia.p50 / 1000.0, latencia.p90 / 1000.0,
+            latencia.p99 / 1000.0, latencia.p999 / 1000.0, latencia.maximo / 1000.0);
+    fclose(arquivo);
+    printf("Resultado acrescentado a %s\n", arquivo_resultados);
+    
+    int sucesso = resultado->falhas == 0 && criados == num_processos;
+    munmap(resultado, sizeof(ResultadoCarga));
+    return sucesso ? 0 : 1;
+}
@@ -1,85 +1,173 @@
-#include "fila.h"
-#include <fcntl.h>
-#include <sys/stat.h>
+#include "envio.h"
+#include <signal.h>
 
-int gerar_id_unico() {
-    return getpid() * 1000 + rand() % 1000;
+// Modo interativo original: um trabalho por vez, com pausas aleatórias
+void enviar_interativo(ConexaoCliente *conexao, GeradorTrabalhos *gerador, int cliente_id,
+                       int num_trabalhos) {
+    for (int i = 0; i < num_trabalhos; i++) {
+        TrabalhoImpressao trabalho = gerar_trabalho_impressao(gerador);
+        
+        printf("Cliente %d enviando trabalho ID: %d, Arquivo: %s, Páginas: %d\n",
+               cliente_id, trabalho.id_job, trabalho.nome_arquivo, trabalho.numero_paginas);
+        
+        int resultado = enviar_lote(conexao, &trabalho, 1);
+        if (resultado == 0 && conexao->socket_fd != -1) {
+            // Pelo socket, espera a confirmação com o ID atribuído pelo servidor
+            resultado = receber_confirmacoes(conexao, 0);
+            if (resultado == 0 && conexao->recusados == 0) {
+                printf("Cliente %d: Trabalho %d enfileirado pelo servidor com ID %d\n",
+                       cliente_id, trabalho.id_job, conexao->ultimo_id);
+            } else {
+                resultado = -1;
+            }
+        } else if (resultado == 0) {
+            printf("Cliente %d: Trabalho %d enviado com sucesso\n", 
+                   cliente_id, trabalho.id_job);
+        }
+        if (resultado != 0) {
+            printf("Cliente %d: Erro ao enviar trabalho %d\n", 
+                   cliente_id, trabalho.id_job);
+        }
+        
+        // Espera um tempo aleatório entre envios (0.5 a 2 segundos)
+        usleep((rand() % 1500000) + 500000);
+    }
 }
 
-TrabalhoImpressao gerar_trabalho_impressao(int cliente_id __attribute__((unused))) {
-    TrabalhoImpressao trabalho;
+// Gerador de carga: lotes de tamanho_lote trabalhos, sem pausas aleatórias;
+// com taxa > 0, limita o envio a taxa trabalhos por segundo
+int enviar_em_lotes(ConexaoCliente *conexao, GeradorTrabalhos *gerador, int cliente_id,
+                    int num_trabalhos, int tamanho_lote, double taxa) {
+    TrabalhoImpressao *lote = malloc(sizeof(TrabalhoImpressao) * tamanho_lote);
+    if (lote == NULL) {
+        perror("Erro ao alocar lote");
+        return -1;
+    }
     
-    trabalho.id_job = gerar_id_unico();
+    double inicio = agora_segundos();
+    int enviados = 0;
     
-    // Gera nomes de arquivo variados
-    char *nomes_arquivos[] = {
-        "documento.pdf", "relatorio.docx", "planilha.xlsx", 
-        "apresentacao.pptx", "imagem.jpg", "texto.txt",
-        "manual.pdf", "contrato.doc", "fatura.pdf"
-    };
-    int num_nomes = sizeof(nomes_arquivos) / sizeof(nomes_arquivos[0]);
-    strcpy(trabalho.nome_arquivo, nomes_arquivos[rand() % num_nomes]);
+    while (enviados < num_trabalhos) {
+        int quantidade = num_trabalhos - enviados;
+        if (quantidade > tamanho_lote) quantidade = tamanho_lote;
+        
+        for (int i = 0; i < quantidade; i++) {
+            lote[i] = gerar_trabalho_impressao(gerador);
+        }
+        
+        // Taxa fixa: o lote sai no instante previsto para seu primeiro trabalho
+        if (taxa > 0) {
+            esperar_ate(inicio + enviados / taxa);
+        }
+        
+        if (enviar_lote(conexao, lote, quantidade) != 0) {
+            printf("Cliente %d: Erro ao enviar lote após %d trabalhos\n", cliente_id, enviados);
+            break;
+        }
+        enviados += quantidade;
+    }
     
-    // Gera número de páginas entre 1 e 10
-    trabalho.numero_paginas = (rand() % 10) + 1;
+    double duracao = agora_segundos() - inicio;
+    printf("Cliente %d: %d trabalhos enviados em %.3f s (%.0f trabalhos/s)\n",
+           cliente_id, enviados, duracao, duracao > 0 ? enviados / duracao : 0.0);
     
-    return trabalho;
+    free(lote);
+    return enviados == num_trabalhos ? 0 : -1;
 }
 
-int enviar_via_pipe(TrabalhoImpressao trabalho) {
-    int fd = open(NOME_PIPE, O_WRONLY);
-    if (fd == -1) {
-        perror("Erro ao abrir pipe para escrita");
-        return -1;
-    }
-    
-    ssize_t bytes_escritos = write(fd, &trabalho, sizeof(TrabalhoImpressao));
-    if (bytes_escritos != sizeof(TrabalhoImpressao)) {
-        perror("Erro ao escrever no pipe");
-        close(fd);
-        return -1;
-    }
-    
-    close(fd);
-    return 0;
+void exibir_uso(const char *programa) {
+    printf("Uso: %s [num_trabalhos] [--shm | --pipe] [--batch N] [--rate R] [--prioridade P] [--paginas D]\n",
+           programa);
+    printf("  --shm      Envia pela memória compartilhada, sem confirmação do servidor\n");
+    printf("  --pipe     Envia pelo named pipe, sem confirmação do servidor\n");
+    printf("  --batch N  Envia lotes de N trabalhos, sem as pausas aleatórias\n");
+    printf("  --rate R   Limita o envio a R trabalhos por segundo (implica --batch)\n");
+    printf("  --prioridade P  0 (alta), 1 (normal, padrão), 2 (baixa) ou mista (sorteada por trabalho)\n");
+    printf("  --paginas D     uniforme:MIN:MAX (padrão 1:10), fixa:N, geometrica:MEDIA[:MAX] ou\n");
+    printf("                  bimodal:PEQUENO:GRANDE:FRACAO\n");
 }
 
 int main(int argc, char *argv[]) {
     int cliente_id = getpid();
     int num_trabalhos = 5; // Padrão: 5 trabalhos por cliente
+    CanalEnvio canal = CANAL_SOCKET;
+    int tamanho_lote = 0;  // 0: modo interativo, um trabalho por vez
+    double taxa = 0;       // 0: sem limite
+    GeradorTrabalhos gerador;
+    inicializar_gerador(&gerador, time(NULL) + cliente_id);
     
-    // Permite especificar número de trabalhos via linha de comando
-    if (argc > 1) {
-        num_trabalhos = atoi(argv[1]);
-        if (num_trabalhos <= 0) {
-            num_trabalhos = 5;
+    // Permite especificar número de trabalhos, canal e modo de envio via linha de comando
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pipe") == 0) {
+            canal = CANAL_PIPE;
+        } else if (strcmp(argv[i], "--shm") == 0) {
+            canal = CANAL_MEMORIA;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            tamanho_lote = atoi(argv[++i]);
+            if (tamanho_lote <= 0) {
+                exibir_uso(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--prioridade") == 0 && i + 1 < argc) {
+            const char *valor = argv[++i];
+            if (strcmp(valor, "mista") == 0) {
+                gerador.prioridade = -1;
+            } else if (valor[0] >= '0' && valor[0] <= '9' && atoi(valor) < NUM_PRIORIDADES) {
+                gerador.prioridade = atoi(valor);
+            } else {
+                exibir_uso(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--paginas") == 0 && i + 1 < argc) {
+            if (configurar_paginas(&gerador, argv[++i]) != 0) {
+                exibir_uso(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            taxa = atof(argv[++i]);
+            if (taxa <= 0) {
+                exibir_uso(argv[0]);
+                return 1;
+            }
+        } else if (argv[i][0] == '-') {
+            exibir_uso(argv[0]);
+            return 1;
+        } else {
+            num_trabalhos = atoi(argv[i]);
+            if (num_trabalhos <= 0) {
+                num_trabalhos = 5;
+            }
         }
     }
+    if (taxa > 0 && tamanho_lote == 0) {
+        tamanho_lote = 1;
+    }
+    
+    // Servidor fechou o pipe: erro de escrita em vez de encerrar o processo
+    signal(SIGPIPE, SIG_IGN);
     
-    // Inicializa gerador de números aleatórios
+    ConexaoCliente conexao;
+    conectar(&conexao, canal);
+    
+    // Pausas aleatórias do modo interativo
     srand(time(NULL) + cliente_id);
     
     printf("Cliente %d iniciado. Enviando %d trabalhos de impressão...\n", 
            cliente_id, num_trabalhos);
     
-    for (int i = 0; i < num_trabalhos; i++) {
-        TrabalhoImpressao trabalho = gerar_trabalho_impressao(cliente_id);
-        
-        printf("Cliente %d enviando trabalho ID: %d, Arquivo: %s, Páginas: %d\n",
-               cliente_id, trabalho.id_job, trabalho.nome_arquivo, trabalho.numero_paginas);
-        
-        if (enviar_via_pipe(trabalho) == 0) {
-            printf("Cliente %d: Trabalho %d enviado com sucesso\n", 
-                   cliente_id, trabalho.id_job);
-        } else {
-            printf("Cliente %d: Erro ao enviar trabalho %d\n", 
-                   cliente_id, trabalho.id_job);
-        }
-        
-        // Espera um tempo aleatório entre envios (0.5 a 2 segundos)
-        usleep((rand() % 1500000) + 500000);
+    int resultado = 0;
+    if (tamanho_lote > 0) {
+        resultado = enviar_em_lotes(&conexao, &gerador, cliente_id, num_trabalhos, tamanho_lote, taxa);
+    } else {
+        enviar_interativo(&conexao, &gerador, cliente_id, num_trabalhos);
+    }
+    
+    desconectar(&conexao);
+    if (conexao.aceitos + conexao.recusados > 0) {
+        printf("Cliente %d: %d trabalhos confirmados pelo servidor, %d recusados\n",
+               cliente_id, conexao.aceitos, conexao.recusados);
     }
     
     printf("Cliente %d finalizou envio de todos os trabalhos\n", cliente_id);
-    return 0;
-}
\ No newline at end of file
+    return resultado == 0 ? 0 : 1;
+}
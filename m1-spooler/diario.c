@@ -0,0 +1,448 @@
+#include "diario.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#define DIARIO_ENFILEIRADO 1
+#define DIARIO_CONCLUIDO 2
+#define DIARIO_MAIOR_ID 3       // Maior ID já atribuído, que a compactação preserva
+
+// Registro do diário, de tamanho fixo. A verificação (FNV-1a dos demais
+// bytes) detecta o registro cortado por uma queda no meio da escrita.
+typedef struct {
+    unsigned int tipo;          // DIARIO_ENFILEIRADO, DIARIO_CONCLUIDO ou DIARIO_MAIOR_ID
+    unsigned int verificacao;
+    TrabalhoImpressao trabalho; // Na conclusão e no maior ID, só id_job
+} RegistroDiario;
+
+typedef struct {
+    char *dados;
+    size_t tamanho;
+    size_t capacidade;
+} BufferDiario;
+
+// Estado do diário: os produtores acrescentam registros ao buffer atual e a
+// thread gravadora leva o outro ao disco com um único fdatasync (group commit)
+static struct {
+    const char *nome;
+    int fd;
+    int ativo;
+    int encerrando;
+    int falhou;
+    off_t tamanho_arquivo;
+    off_t limite_compactacao;
+    unsigned long long registrados; // Registros aceitos (no buffer ou no disco)
+    unsigned long long duraveis;    // Registros já sincronizados
+    BufferDiario buffers[2];
+    int atual;                      // Buffer que recebe os registros
+    pthread_mutex_t trava;
+    pthread_cond_t tem_registros;
+    pthread_cond_t gravados;
+    pthread_t gravador;
+} diario_global = { NULL, -1, 0, 0, 0, 0, 0, 0, 0, { { NULL, 0, 0 }, { NULL, 0, 0 } }, 0,
+                    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+
+static unsigned int verificar_registro(const RegistroDiario *registro) {
+    const unsigned char *bytes = (const unsigned char *)registro;
+    unsigned int hash = 2166136261u;
+    
+    for (size_t i = 0; i < sizeof(RegistroDiario); i++) {
+        if (i >= offsetof(RegistroDiario, verificacao) &&
+            i < offsetof(RegistroDiario, verificacao) + sizeof(registro->verificacao)) continue;
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void preencher_registro(RegistroDiario *registro, unsigned int tipo, const TrabalhoImpressao *trabalho) {
+    memset(registro, 0, sizeof(*registro));
+    registro->tipo = tipo;
+    if (tipo == DIARIO_ENFILEIRADO) {
+        memcpy(&registro->trabalho, trabalho, sizeof(TrabalhoImpressao));
+    } else {
+        registro->trabalho.id_job = trabalho->id_job;
+    }
+    registro->verificacao = verificar_registro(registro);
+}
+
+static int escrever_tudo(int fd, const char *dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t escritos = write(fd, dados, tamanho);
+        if (escritos == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        dados += escritos;
+        tamanho -= escritos;
+    }
+    return 0;
+}
+
+static int comparar_ids(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Lê os registros válidos do diário (para no primeiro inválido: escrita
+// interrompida) e devolve, na ordem do diário, os trabalhos sem conclusão.
+// Diário inexistente conta como vazio.
+static int ler_pendentes(const char *nome, TrabalhoImpressao **pendentes, int *quantidade, int *maior_id) {
+    *pendentes = NULL;
+    *quantidade = 0;
+    if (maior_id != NULL) *maior_id = 0;
+    
+    int fd = open(nome, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return errno == ENOENT ? 0 : -1;
+    
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -1;
+    }
+    
+    size_t maximo = info.st_size / sizeof(RegistroDiario);
+    RegistroDiario *registros = malloc((maximo ? maximo : 1) * sizeof(RegistroDiario));
+    int *concluidos = malloc((maximo ? maximo : 1) * sizeof(int));
+    if (registros == NULL || concluidos == NULL) {
+        free(registros);
+        free(concluidos);
+        close(fd);
+        return -1;
+    }
+    
+    size_t lidos = 0;
+    size_t total = maximo * sizeof(RegistroDiario);
+    while (lidos < total) {
+        ssize_t n = read(fd, (char *)registros + lidos, total - lidos);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) break;
+        lidos += n;
+    }
+    close(fd);
+    
+    size_t validos = 0;
+    int num_concluidos = 0;
+    int num_enfileirados = 0;
+    for (; validos < lidos / sizeof(RegistroDiario); validos++) {
+        const RegistroDiario *registro = &registros[validos];
+        if (registro->tipo < DIARIO_ENFILEIRADO || registro->tipo > DIARIO_MAIOR_ID ||
+            registro->verificacao != verificar_registro(registro)) {
+            break;
+        }
+        
+        if (registro->tipo == DIARIO_CONCLUIDO) {
+            concluidos[num_concluidos++] = registro->trabalho.id_job;
+        } else if (registro->tipo == DIARIO_ENFILEIRADO) {
+            num_enfileirados++;
+        }
+        if (maior_id != NULL && registro->trabalho.id_job > *maior_id) *maior_id = registro->trabalho.id_job;
+    }
+    
+    qsort(concluidos, num_concluidos, sizeof(int), comparar_ids);
+    
+    TrabalhoImpressao *resultado = malloc((num_enfileirados ? num_enfileirados : 1) * sizeof(TrabalhoImpressao));
+    if (resultado == NULL) {
+        free(registros);
+        free(concluidos);
+        return -1;
+    }
+    
+    for (size_t i = 0; i < validos; i++) {
+        if (registros[i].tipo == DIARIO_ENFILEIRADO &&
+            bsearch(&registros[i].trabalho.id_job, concluidos, num_concluidos, sizeof(int), comparar_ids) == NULL) {
+            resultado[(*quantidade)++] = registros[i].trabalho;
+        }
+    }
+    
+    free(registros);
+    free(concluidos);
+    *pendentes = resultado;
+    return 0;
+}
+
+// Sincroniza o diretório do diário, para que o rename sobreviva a uma queda
+static void sincronizar_diretorio(const char *nome) {
+    char diretorio[256] = ".";
+    const char *barra = strrchr(nome, '/');
+    
+    if (barra != NULL) {
+        size_t tamanho = barra == nome ? 1 : (size_t)(barra - nome);
+        if (tamanho >= sizeof(diretorio)) return;
+        memcpy(diretorio, nome, tamanho);
+        diretorio[tamanho] = '\0';
+    }
+    
+    int fd = open(diretorio, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// Grava o maior ID e os pendentes num arquivo novo e o põe no lugar do diário
+// (rename atômico). Retorna o descritor do novo diário, aberto para acréscimo.
+static int reescrever_diario(const char *nome, const TrabalhoImpressao *pendentes, int quantidade,
+                             int maior_id) {
+    char temporario[256];
+    RegistroDiario bloco[LOTE_INGESTAO];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", nome);
+    
+    int fd = open(temporario, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) return -1;
+    
+    // Sem ele, um diário vazio faria os IDs recomeçarem em 1 na próxima partida
+    TrabalhoImpressao marca = { .id_job = maior_id };
+    preencher_registro(&bloco[0], DIARIO_MAIOR_ID, &marca);
+    if (escrever_tudo(fd, (const char *)bloco, sizeof(RegistroDiario)) != 0) {
+        close(fd);
+        unlink(temporario);
+        return -1;
+    }
+    
+    for (int i = 0; i < quantidade; i += LOTE_INGESTAO) {
+        int parte = quantidade - i < LOTE_INGESTAO ? quantidade - i : LOTE_INGESTAO;
+        for (int j = 0; j < parte; j++) {
+            preencher_registro(&bloco[j], DIARIO_ENFILEIRADO, &pendentes[i + j]);
+        }
+        if (escrever_tudo(fd, (const char *)bloco, parte * sizeof(RegistroDiario)) != 0) {
+            close(fd);
+            unlink(temporario);
+            return -1;
+        }
+    }
+    
+    if (fdatasync(fd) != 0 || rename(temporario, nome) != 0) {
+        close(fd);
+        unlink(temporario);
+        return -1;
+    }
+    sincronizar_diretorio(nome);
+    return fd;
+}
+
+// Reescreve o diário só com os pendentes e o maior ID (o do arquivo ou
+// maior_id, se for maior). Chamada pela gravadora (a única que escreve no
+// arquivo); os registros que chegam enquanto isso ficam no buffer.
+static int compactar_diario(int maior_id) {
+    TrabalhoImpressao *pendentes;
+    int quantidade;
+    int maior_lido;
+    
+    if (ler_pendentes(diario_global.nome, &pendentes, &quantidade, &maior_lido) != 0) return -1;
+    if (maior_lido > maior_id) maior_id = maior_lido;
+    
+    int fd = reescrever_diario(diario_global.nome, pendentes, quantidade, maior_id);
+    free(pendentes);
+    if (fd == -1) return -1;
+    
+    close(diario_global.fd);
+    diario_global.fd = fd;
+    diario_global.tamanho_arquivo = (off_t)(quantidade + 1) * sizeof(RegistroDiario);
+    
+    // Com muitos pendentes, só compacta de novo depois que o diário dobrar
+    diario_global.limite_compactacao = diario_global.tamanho_arquivo * 2;
+    if (diario_global.limite_compactacao < DIARIO_LIMITE_COMPACTACAO) {
+        diario_global.limite_compactacao = DIARIO_LIMITE_COMPACTACAO;
+    }
+    return quantidade;
+}
+
+// Thread gravadora: leva ao disco tudo o que se acumulou desde a última
+// sincronização; quanto mais lento o disco, maior o grupo de cada fdatasync
+static void *thread_gravador_diario(void *arg) {
+    (void)arg;
+    int erro_registrado = 0;
+    
+    pthread_mutex_lock(&diario_global.trava);
+    for (;;) {
+        while (diario_global.buffers[diario_global.atual].tamanho == 0 && !diario_global.encerrando) {
+            pthread_cond_wait(&diario_global.tem_registros, &diario_global.trava);
+        }
+        
+        BufferDiario *buffer = &diario_global.buffers[diario_global.atual];
+        if (buffer->tamanho == 0) break;
+        
+        // Os produtores seguem no outro buffer enquanto este vai ao disco
+        diario_global.atual ^= 1;
+        unsigned long long alvo = diario_global.registrados;
+        pthread_mutex_unlock(&diario_global.trava);
+        
+        int erro = escrever_tudo(diario_global.fd, buffer->dados, buffer->tamanho) != 0 ||
+                   fdatasync(diario_global.fd) != 0;
+        diario_global.tamanho_arquivo += buffer->tamanho;
+        buffer->tamanho = 0;
+        if (erro && !erro_registrado) {
+            log_evento("Erro ao gravar o diário - lotes do socket passam a ser recusados");
+            erro_registrado = 1;
+        }
+        
+        pthread_mutex_lock(&diario_global.trava);
+        diario_global.duraveis = alvo;
+        if (erro) diario_global.falhou = 1;
+        pthread_cond_broadcast(&diario_global.gravados);
+        
+        if (diario_global.tamanho_arquivo > diario_global.limite_compactacao) {
+            pthread_mutex_unlock(&diario_global.trava);
+            
+            char evento[128];
+            off_t anterior = diario_global.tamanho_arquivo;
+            int pendentes = compactar_diario(0);
+            if (pendentes >= 0) {
+                snprintf(evento, sizeof(evento), "Diário compactado: %lld -> %lld bytes (%d trabalhos pendentes)",
+                         (long long)anterior, (long long)diario_global.tamanho_arquivo, pendentes);
+                log_evento(evento);
+            }
+            
+            pthread_mutex_lock(&diario_global.trava);
+        }
+    }
+    pthread_mutex_unlock(&diario_global.trava);
+    
+    return NULL;
+}
+
+// Reserva espaço para quantidade registros no buffer atual (com a trava)
+static RegistroDiario *reservar_registros(int quantidade) {
+    BufferDiario *buffer = &diario_global.buffers[diario_global.atual];
+    size_t necessario = buffer->tamanho + quantidade * sizeof(RegistroDiario);
+    
+    if (necessario > buffer->capacidade) {
+        size_t nova = buffer->capacidade ? buffer->capacidade : DIARIO_TAMANHO_BUFFER;
+        while (nova < necessario) nova *= 2;
+        char *dados = realloc(buffer->dados, nova);
+        if (dados == NULL) return NULL;
+        buffer->dados = dados;
+        buffer->capacidade = nova;
+    }
+    
+    RegistroDiario *registros = (RegistroDiario *)(buffer->dados + buffer->tamanho);
+    buffer->tamanho = necessario;
+    return registros;
+}
+
+// Lê o diário, compacta-o nos trabalhos pendentes (devolvidos em pendentes,
+// para o servidor recolocar na fila) e inicia a thread gravadora
+int abrir_diario(const char *nome_arquivo, TrabalhoImpressao **pendentes, int *quantidade, int *maior_id) {
+    if (ler_pendentes(nome_arquivo, pendentes, quantidade, maior_id) != 0) {
+        perror("Erro ao ler o diário");
+        return -1;
+    }
+    
+    int fd = reescrever_diario(nome_arquivo, *pendentes, *quantidade, *maior_id);
+    if (fd == -1) {
+        perror("Erro ao reescrever o diário");
+        free(*pendentes);
+        *pendentes = NULL;
+        return -1;
+    }
+    
+    diario_global.nome = nome_arquivo;
+    diario_global.fd = fd;
+    diario_global.tamanho_arquivo = (off_t)(*quantidade + 1) * sizeof(RegistroDiario);
+    diario_global.limite_compactacao = DIARIO_LIMITE_COMPACTACAO;
+    diario_global.encerrando = 0;
+    diario_global.falhou = 0;
+    
+    if (pthread_create(&diario_global.gravador, NULL, thread_gravador_diario, NULL) != 0) {
+        perror("Erro ao criar thread do diário");
+        close(fd);
+        free(*pendentes);
+        *pendentes = NULL;
+        return -1;
+    }
+    
+    diario_global.ativo = 1;
+    return 0;
+}
+
+// Grava o que falta, compacta e fecha o diário, guardando maior_id (o último
+// ID atribuído, inclusive aos trabalhos que não passam pelo diário). Retorna
+// quantos trabalhos ficaram pendentes para a próxima partida (-1 em erro).
+int fechar_diario(int maior_id) {
+    if (!diario_global.ativo) return 0;
+    
+    pthread_mutex_lock(&diario_global.trava);
+    diario_global.encerrando = 1;
+    pthread_cond_signal(&diario_global.tem_registros);
+    pthread_mutex_unlock(&diario_global.trava);
+    pthread_join(diario_global.gravador, NULL);
+    
+    int pendentes = compactar_diario(maior_id);
+    
+    close(diario_global.fd);
+    diario_global.fd = -1;
+    for (int i = 0; i < 2; i++) {
+        free(diario_global.buffers[i].dados);
+        diario_global.buffers[i].dados = NULL;
+        diario_global.buffers[i].tamanho = 0;
+        diario_global.buffers[i].capacidade = 0;
+    }
+    diario_global.ativo = 0;
+    
+    return pendentes;
+}
+
+// Registra a entrada de um lote, antes de ele ir para a fila. Retorna a
+// sequência a passar para diario_aguardar antes de confirmar o lote.
+unsigned long long diario_registrar_enfileirados(const TrabalhoImpressao *trabalhos, int quantidade) {
+    if (!diario_global.ativo || quantidade <= 0) return 0;
+    
+    pthread_mutex_lock(&diario_global.trava);
+    RegistroDiario *registros = reservar_registros(quantidade);
+    if (registros == NULL) {
+        diario_global.falhou = 1;
+    } else {
+        for (int i = 0; i < quantidade; i++) {
+            preencher_registro(&registros[i], DIARIO_ENFILEIRADO, &trabalhos[i]);
+        }
+        diario_global.registrados += quantidade;
+        pthread_cond_signal(&diario_global.tem_registros);
+    }
+    unsigned long long sequencia = diario_global.registrados;
+    pthread_mutex_unlock(&diario_global.trava);
+    
+    return sequencia;
+}
+
+// Registra o fim da impressão; não espera o disco (perder a conclusão numa
+// queda só faz o trabalho ser impresso de novo)
+void diario_registrar_concluido(int id_job) {
+    if (!diario_global.ativo) return;
+    TrabalhoImpressao trabalho = { .id_job = id_job };
+    
+    pthread_mutex_lock(&diario_global.trava);
+    RegistroDiario *registro = reservar_registros(1);
+    if (registro != NULL) {
+        preencher_registro(registro, DIARIO_CONCLUIDO, &trabalho);
+        diario_global.registrados++;
+        pthread_cond_signal(&diario_global.tem_registros);
+    }
+    pthread_mutex_unlock(&diario_global.trava);
+}
+
+unsigned long long diario_ultimo_registro(void) {
+    if (!diario_global.ativo) return 0;
+    
+    pthread_mutex_lock(&diario_global.trava);
+    unsigned long long sequencia = diario_global.registrados;
+    pthread_mutex_unlock(&diario_global.trava);
+    return sequencia;
+}
+
+// Bloqueia até os registros até sequencia estarem em disco. Retorna -1 se o
+// diário falhou (e não há mais garantia de durabilidade).
+int diario_aguardar(unsigned long long sequencia) {
+    if (!diario_global.ativo) return 0;
+    
+    pthread_mutex_lock(&diario_global.trava);
+    while (diario_global.duraveis < sequencia && !diario_global.falhou) {
+        pthread_cond_wait(&diario_global.gravados, &diario_global.trava);
+    }
+    int resultado = diario_global.falhou ? -1 : 0;
+    pthread_mutex_unlock(&diario_global.trava);
+    
+    return resultado;
+}
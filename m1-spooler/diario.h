@@ -0,0 +1,18 @@
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include "fila.h"
+
+#define ARQUIVO_DIARIO "diario_servidor.dat"
+#define DIARIO_LIMITE_COMPACTACAO (16 * 1024 * 1024)   // Tamanho que dispara a compactação
+#define DIARIO_TAMANHO_BUFFER (256 * 1024)              // Buffer inicial de cada lado do group commit
+
+// Protótipos das funções
+int abrir_diario(const char *nome_arquivo, TrabalhoImpressao **pendentes, int *quantidade, int *maior_id);
+int fechar_diario(int maior_id);
+unsigned long long diario_registrar_enfileirados(const TrabalhoImpressao *trabalhos, int quantidade);
+void diario_registrar_concluido(int id_job);
+unsigned long long diario_ultimo_registro(void);
+int diario_aguardar(unsigned long long sequencia);
+
+#endif
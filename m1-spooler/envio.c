@@ -0,0 +1,294 @@
+#include "envio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Geração de trabalhos e envio ao servidor, comuns ao cliente e ao gerador de carga
+
+#define ESPERA_MEMORIA_MS 100   // Espera máxima pelo anel cheio entre conferências do servidor
+
+// Semente própria e distribuição padrão do cliente: 1 a 10 páginas, prioridade normal
+void inicializar_gerador(GeradorTrabalhos *gerador, unsigned int semente) {
+    gerador->semente = semente;
+    gerador->prioridade = PRIORIDADE_NORMAL;
+    gerador->distribuicao = PAGINAS_UNIFORME;
+    gerador->minimo = 1;
+    gerador->maximo = 10;
+    gerador->fracao_grandes = 0;
+}
+
+// Lê a distribuição de páginas: uniforme:MIN:MAX, fixa:N, geometrica:MEDIA[:MAX]
+// ou bimodal:PEQUENO:GRANDE:FRACAO. Retorna -1 se a descrição é inválida.
+int configurar_paginas(GeradorTrabalhos *gerador, const char *descricao) {
+    int minimo = 0, maximo = 0;
+    double fracao = 0;
+    char resto = '\0';
+    
+    if (sscanf(descricao, "uniforme:%d:%d%c", &minimo, &maximo, &resto) == 2 &&
+        minimo >= 1 && maximo >= minimo) {
+        gerador->distribuicao = PAGINAS_UNIFORME;
+    } else if (sscanf(descricao, "fixa:%d%c", &minimo, &resto) == 1 && minimo >= 1) {
+        gerador->distribuicao = PAGINAS_FIXA;
+        maximo = minimo;
+    } else if (sscanf(descricao, "geometrica:%d%c", &minimo, &resto) == 1 && minimo >= 1) {
+        gerador->distribuicao = PAGINAS_GEOMETRICA;
+        maximo = INT_MAX;
+    } else if (sscanf(descricao, "geometrica:%d:%d%c", &minimo, &maximo, &resto) == 2 &&
+               minimo >= 1 && maximo >= minimo) {
+        gerador->distribuicao = PAGINAS_GEOMETRICA;
+    } else if (sscanf(descricao, "bimodal:%d:%d:%lf%c", &minimo, &maximo, &fracao, &resto) == 3 &&
+               minimo >= 1 && maximo >= minimo && fracao >= 0 && fracao <= 1) {
+        gerador->distribuicao = PAGINAS_BIMODAL;
+    } else {
+        return -1;
+    }
+    
+    gerador->minimo = minimo;
+    gerador->maximo = maximo;
+    gerador->fracao_grandes = fracao;
+    return 0;
+}
+
+// Sorteio uniforme em [0, 1)
+static double sortear_fracao(GeradorTrabalhos *gerador) {
+    return rand_r(&gerador->semente) / ((double)RAND_MAX + 1);
+}
+
+static int sortear_paginas(GeradorTrabalhos *gerador) {
+    switch (gerador->distribuicao) {
+    case PAGINAS_FIXA:
+        return gerador->minimo;
+    case PAGINAS_GEOMETRICA: {
+        // Tentativas até o primeiro sucesso com chance 1/minimo: média minimo
+        if (gerador->minimo == 1) return 1;
+        double paginas = 1 + floor(log(1 - sortear_fracao(gerador)) / log(1 - 1.0 / gerador->minimo));
+        return paginas > gerador->maximo ? gerador->maximo : (int)paginas;
+    }
+    case PAGINAS_BIMODAL:
+        return sortear_fracao(gerador) < gerador->fracao_grandes ? gerador->maximo : gerador->minimo;
+    default:
+        return gerador->minimo + rand_r(&gerador->semente) % (gerador->maximo - gerador->minimo + 1);
+    }
+}
+
+TrabalhoImpressao gerar_trabalho_impressao(GeradorTrabalhos *gerador) {
+    TrabalhoImpressao trabalho;
+    
+    // O servidor atribui o ID definitivo na confirmação
+    trabalho.id_job = getpid() * 1000 + rand_r(&gerador->semente) % 1000;
+    
+    // Gera nomes de arquivo variados
+    static const char *nomes_arquivos[] = {
+        "documento.pdf", "relatorio.docx", "planilha.xlsx", 
+        "apresentacao.pptx", "imagem.jpg", "texto.txt",
+        "manual.pdf", "contrato.doc", "fatura.pdf"
+    };
+    int num_nomes = sizeof(nomes_arquivos) / sizeof(nomes_arquivos[0]);
+    strcpy(trabalho.nome_arquivo, nomes_arquivos[rand_r(&gerador->semente) % num_nomes]);
+    
+    trabalho.numero_paginas = sortear_paginas(gerador);
+    
+    trabalho.prioridade = gerador->prioridade >= 0 ? gerador->prioridade
+                                                   : rand_r(&gerador->semente) % NUM_PRIORIDADES;
+    trabalho.recebido_ns = 0;   // O servidor marca a recepção
+    
+    return trabalho;
+}
+
+// Conecta ao socket Unix do servidor; -1 se o servidor não o oferece
+static int conectar_socket(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strncpy(endereco.sun_path, NOME_SOCKET, sizeof(endereco.sun_path) - 1);
+    
+    if (connect(fd, (struct sockaddr *)&endereco, sizeof(endereco)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void conectar(ConexaoCliente *conexao, CanalEnvio canal) {
+    memset(conexao, 0, sizeof(*conexao));
+    conexao->socket_fd = -1;
+    conexao->pipe_fd = -1;
+    
+    // Socket se o servidor o oferece; senão memória compartilhada; senão o pipe
+    if (canal == CANAL_SOCKET) {
+        conexao->socket_fd = conectar_socket();
+    }
+    if (conexao->socket_fd == -1 && canal != CANAL_PIPE) {
+        conexao->memoria = anexar_memoria_compartilhada();
+    }
+}
+
+// Lê confirmações do servidor até restarem no máximo limite trabalhos em trânsito
+int receber_confirmacoes(ConexaoCliente *conexao, int limite) {
+    char *bytes = (char *)conexao->recebidas;
+    const int capacidade = sizeof(conexao->recebidas) / sizeof(ConfirmacaoTrabalho);
+    
+    while (conexao->em_transito > limite) {
+        int esperadas = conexao->em_transito < capacidade ? conexao->em_transito : capacidade;
+        ssize_t lidos = read(conexao->socket_fd, bytes + conexao->bytes_recebidos,
+                             esperadas * sizeof(ConfirmacaoTrabalho) - conexao->bytes_recebidos);
+        if (lidos == -1 && errno == EINTR) continue;
+        if (lidos <= 0) {
+            fprintf(stderr, "Servidor encerrou a conexão com %d trabalhos sem confirmação\n",
+                    conexao->em_transito);
+            return -1;
+        }
+        conexao->bytes_recebidos += lidos;
+        
+        int completas = conexao->bytes_recebidos / sizeof(ConfirmacaoTrabalho);
+        for (int i = 0; i < completas; i++) {
+            if (conexao->recebidas[i].status == 0) {
+                conexao->aceitos++;
+            } else {
+                conexao->recusados++;
+            }
+            conexao->ultimo_id = conexao->recebidas[i].id_job;
+            if (conexao->ao_confirmar != NULL) {
+                conexao->ao_confirmar(conexao->contexto, &conexao->recebidas[i]);
+            }
+        }
+        conexao->em_transito -= completas;
+        
+        size_t usados = completas * sizeof(ConfirmacaoTrabalho);
+        memmove(bytes, bytes + usados, conexao->bytes_recebidos - usados);
+        conexao->bytes_recebidos -= usados;
+    }
+    return 0;
+}
+
+// Escreve o lote no socket, mantendo no máximo JANELA_CONFIRMACOES trabalhos
+// sem confirmação (o servidor para de ler clientes que não leem as confirmações)
+int enviar_via_socket(ConexaoCliente *conexao, const TrabalhoImpressao *trabalhos, int quantidade) {
+    while (quantidade > 0) {
+        int parte = quantidade < JANELA_CONFIRMACOES ? quantidade : JANELA_CONFIRMACOES;
+        if (receber_confirmacoes(conexao, JANELA_CONFIRMACOES - parte) != 0) return -1;
+        
+        const char *bytes = (const char *)trabalhos;
+        size_t restantes = parte * sizeof(TrabalhoImpressao);
+        while (restantes > 0) {
+            ssize_t escritos = write(conexao->socket_fd, bytes, restantes);
+            if (escritos == -1 && errno == EINTR) continue;
+            if (escritos <= 0) {
+                perror("Erro ao escrever no socket");
+                return -1;
+            }
+            bytes += escritos;
+            restantes -= escritos;
+        }
+        
+        conexao->em_transito += parte;
+        trabalhos += parte;
+        quantidade -= parte;
+    }
+    return 0;
+}
+
+void desconectar(ConexaoCliente *conexao) {
+    if (conexao->socket_fd != -1) {
+        // Espera a confirmação de tudo o que foi enviado
+        receber_confirmacoes(conexao, 0);
+        close(conexao->socket_fd);
+        conexao->socket_fd = -1;
+    }
+    
+    liberar_memoria_compartilhada(conexao->memoria, 0);
+    conexao->memoria = NULL;
+    
+    if (conexao->pipe_fd != -1) {
+        close(conexao->pipe_fd);
+        conexao->pipe_fd = -1;
+    }
+}
+
+// Escreve o lote no pipe mantido aberto. Cada write leva no máximo PIPE_BUF
+// bytes de registros inteiros, que o kernel não intercala com outros clientes.
+static int enviar_via_pipe(ConexaoCliente *conexao, const TrabalhoImpressao *trabalhos, int quantidade) {
+    if (conexao->pipe_fd == -1) {
+        // Sem O_NONBLOCK o open esperaria para sempre se nenhum servidor lê o pipe
+        conexao->pipe_fd = open(NOME_PIPE, O_WRONLY | O_NONBLOCK);
+        if (conexao->pipe_fd == -1) {
+            perror("Erro ao abrir pipe para escrita");
+            return -1;
+        }
+        fcntl(conexao->pipe_fd, F_SETFL, fcntl(conexao->pipe_fd, F_GETFL) & ~O_NONBLOCK);
+    }
+    
+    const int por_escrita = PIPE_BUF / sizeof(TrabalhoImpressao);
+    while (quantidade > 0) {
+        int parte = quantidade < por_escrita ? quantidade : por_escrita;
+        size_t bytes = parte * sizeof(TrabalhoImpressao);
+        
+        ssize_t bytes_escritos = write(conexao->pipe_fd, trabalhos, bytes);
+        if (bytes_escritos != (ssize_t)bytes) {
+            perror("Erro ao escrever no pipe");
+            close(conexao->pipe_fd);
+            conexao->pipe_fd = -1;
+            return -1;
+        }
+        
+        trabalhos += parte;
+        quantidade -= parte;
+    }
+    
+    return 0;
+}
+
+// Enfileira o lote no anel em memória compartilhada; sem chamadas de sistema
+// enquanto o servidor não está ocioso. Com o anel cheio, espera em fatias de
+// ESPERA_MEMORIA_MS e confere entre elas se o servidor não morreu.
+// Retorna quantos trabalhos entraram.
+static int enviar_via_memoria(MemoriaCompartilhada *memoria, const TrabalhoImpressao *trabalhos, int quantidade) {
+    int enviados = 0;
+    while (enviados < quantidade && servidor_memoria_vivo(memoria)) {
+        enviados += enfileirar_lote_ate(fila_compartilhada(memoria), trabalhos + enviados,
+                                        quantidade - enviados, ESPERA_MEMORIA_MS);
+    }
+    return enviados;
+}
+
+// Envia um lote de trabalhos pelo melhor canal disponível
+int enviar_lote(ConexaoCliente *conexao, const TrabalhoImpressao *trabalhos, int quantidade) {
+    if (conexao->socket_fd != -1) {
+        return enviar_via_socket(conexao, trabalhos, quantidade);
+    }
+    if (conexao->memoria != NULL) {
+        int enviados = enviar_via_memoria(conexao->memoria, trabalhos, quantidade);
+        if (enviados == quantidade) return 0;
+        
+        // Servidor deixou o canal compartilhado (ou morreu): o restante segue pelo pipe
+        liberar_memoria_compartilhada(conexao->memoria, 0);
+        conexao->memoria = NULL;
+        trabalhos += enviados;
+        quantidade -= enviados;
+    }
+    return enviar_via_pipe(conexao, trabalhos, quantidade);
+}
+
+// Instante atual em segundos (relógio monotônico)
+double agora_segundos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Dorme até o instante (relógio monotônico) em que o próximo lote deve sair
+void esperar_ate(double instante) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)instante;
+    ts.tv_nsec = (long)((instante - ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        // Interrompido por sinal: continua esperando
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ENVIO_H
+#define ENVIO_H
+
+#include "fila.h"
+
+// Distribuição do número de páginas dos trabalhos gerados
+typedef enum {
+    PAGINAS_UNIFORME,   // Entre minimo e maximo (padrão 1 a 10)
+    PAGINAS_FIXA,       // Sempre minimo
+    PAGINAS_GEOMETRICA, // Média minimo, cortada em maximo
+    PAGINAS_BIMODAL     // minimo ou maximo; maximo com chance fracao_grandes
+} DistribuicaoPaginas;
+
+// Gerador de trabalhos com semente própria: uma instância por thread
+typedef struct {
+    unsigned int semente;
+    int prioridade;             // -1 sorteia uma por trabalho
+    DistribuicaoPaginas distribuicao;
+    int minimo;
+    int maximo;
+    double fracao_grandes;
+} GeradorTrabalhos;
+
+// Canais de envio, em ordem de preferência
+typedef enum { CANAL_SOCKET, CANAL_MEMORIA, CANAL_PIPE } CanalEnvio;
+
+// Conexão do cliente com o servidor, aberta uma vez por execução
+typedef struct {
+    int socket_fd;                  // Canal principal, com confirmação (-1 se indisponível)
+    MemoriaCompartilhada *memoria;  // Sem confirmação e sem chamadas de sistema (NULL se indisponível)
+    int pipe_fd;                    // Alternativa final: named pipe (-1 se fechado)
+    int em_transito;                // Trabalhos enviados pelo socket ainda sem confirmação
+    int aceitos;
+    int recusados;
+    int ultimo_id;                  // ID atribuído pelo servidor ao último trabalho confirmado
+    ConfirmacaoTrabalho recebidas[256];
+    size_t bytes_recebidos;         // Confirmação partida entre leituras
+    // Opcional: chamada a cada confirmação, na ordem de envio
+    void (*ao_confirmar)(void *contexto, const ConfirmacaoTrabalho *confirmacao);
+    void *contexto;
+} ConexaoCliente;
+
+// Protótipos das funções
+void inicializar_gerador(GeradorTrabalhos *gerador, unsigned int semente);
+int configurar_paginas(GeradorTrabalhos *gerador, const char *descricao);
+TrabalhoImpressao gerar_trabalho_impressao(GeradorTrabalhos *gerador);
+void conectar(ConexaoCliente *conexao, CanalEnvio canal);
+int receber_confirmacoes(ConexaoCliente *conexao, int limite);
+int enviar_via_socket(ConexaoCliente *conexao, const TrabalhoImpressao *trabalhos, int quantidade);
+int enviar_lote(ConexaoCliente *conexao, const TrabalhoImpressao *trabalhos, int quantidade);
+void desconectar(ConexaoCliente *conexao);
+double agora_segundos(void);
+void esperar_ate(double instante);
+
+#endif
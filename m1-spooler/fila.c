@@ -1,114 +1,800 @@
 #include "fila.h"
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
-// Inicializa a fila de impressão
-void inicializar_fila(FilaImpressao *fila) {
-    fila->inicio = NULL;
-    fila->fim = NULL;
-    fila->tamanho = 0;
+// Dorme enquanto *endereco == valor (retorna na hora se já mudou).
+// timeout_ms < 0 espera sem limite.
+void futex_esperar(unsigned int *endereco, unsigned int valor, int timeout_ms) {
+    struct timespec limite;
+    struct timespec *ptr_limite = NULL;
+    
+    if (timeout_ms >= 0) {
+        limite.tv_sec = timeout_ms / 1000;
+        limite.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        ptr_limite = &limite;
+    }
+    syscall(SYS_futex, endereco, FUTEX_WAIT, valor, ptr_limite, NULL, 0);
+}
+
+// Acorda até quantidade threads dormindo em endereco
+void futex_acordar(unsigned int *endereco, int quantidade) {
+    syscall(SYS_futex, endereco, FUTEX_WAKE, quantidade, NULL, NULL, 0);
+}
+
+// Contadores de contenção desta thread, para o benchmark da fila
+static __thread ContencaoFila contencao_thread;
+
+// Avisa até quantidade threads dormindo em versao, se houver alguém esperando
+static void sinalizar(unsigned int *versao, unsigned int *esperando, int quantidade) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(esperando, __ATOMIC_RELAXED) > 0) {
+        __atomic_add_fetch(versao, 1, __ATOMIC_RELEASE);
+        futex_acordar(versao, quantidade);
+    }
+}
+
+// Tenta inserir sem bloquear: reserva de uma vez (um único CAS) as posições
+// livres consecutivas, até quantidade. Retorna quantas inseriu (0 = anel cheio).
+static int tentar_enfileirar(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade) {
+    unsigned long long pos = __atomic_load_n(&fila->fim, __ATOMIC_RELAXED);
     
-    // Inicializa mutex
-    pthread_mutex_init(&fila->mutex, NULL);
+    for (;;) {
+        // Slots livres nesta volta têm sequência igual à posição
+        int livres = 0;
+        long long diferenca = 0;
+        while (livres < quantidade) {
+            SlotFila *slot = &fila->slots[(pos + livres) % fila->capacidade];
+            unsigned long long seq = __atomic_load_n(&slot->sequencia, __ATOMIC_ACQUIRE);
+            diferenca = (long long)(seq - (pos + livres));
+            if (diferenca != 0) break;
+            livres++;
+        }
+        
+        if (livres == 0) {
+            if (diferenca < 0) return 0;    // Slot ainda ocupado da volta anterior
+            pos = __atomic_load_n(&fila->fim, __ATOMIC_RELAXED);
+            contencao_thread.cas_falhos++;
+            continue;
+        }
+        
+        if (__atomic_compare_exchange_n(&fila->fim, &pos, pos + livres, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (int i = 0; i < livres; i++) {
+                SlotFila *slot = &fila->slots[(pos + i) % fila->capacidade];
+                slot->trabalho = trabalhos[i];
+                __atomic_store_n(&slot->sequencia, pos + i + 1, __ATOMIC_RELEASE);
+            }
+            return livres;
+        }
+        contencao_thread.cas_falhos++;
+    }
+}
+
+// Tenta retirar sem bloquear: reserva de uma vez os slots preenchidos
+// consecutivos, até maximo. Retorna quantos retirou (0 = anel vazio).
+static int tentar_desenfileirar(FilaImpressao *fila, TrabalhoImpressao *trabalhos, int maximo) {
+    unsigned long long pos = __atomic_load_n(&fila->inicio, __ATOMIC_RELAXED);
     
-    // Inicializa semáforos
-    sem_init(&fila->vazio, 0, 0);          // Inicialmente não há trabalhos
-    sem_init(&fila->cheio, 0, MAX_TRABALHOS); // Inicialmente há MAX_TRABALHOS espaços livres
+    for (;;) {
+        // Slots publicados têm sequência igual à posição + 1
+        int prontos = 0;
+        long long diferenca = 0;
+        while (prontos < maximo) {
+            SlotFila *slot = &fila->slots[(pos + prontos) % fila->capacidade];
+            unsigned long long seq = __atomic_load_n(&slot->sequencia, __ATOMIC_ACQUIRE);
+            diferenca = (long long)(seq - (pos + prontos + 1));
+            if (diferenca != 0) break;
+            prontos++;
+        }
+        
+        if (prontos == 0) {
+            if (diferenca < 0) return 0;    // Produtor ainda não publicou este slot
+            pos = __atomic_load_n(&fila->inicio, __ATOMIC_RELAXED);
+            contencao_thread.cas_falhos++;
+            continue;
+        }
+        
+        if (__atomic_compare_exchange_n(&fila->inicio, &pos, pos + prontos, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (int i = 0; i < prontos; i++) {
+                SlotFila *slot = &fila->slots[(pos + i) % fila->capacidade];
+                trabalhos[i] = slot->trabalho;
+                // Libera o slot para a próxima volta do anel
+                __atomic_store_n(&slot->sequencia, pos + i + fila->capacidade, __ATOMIC_RELEASE);
+            }
+            return prontos;
+        }
+        contencao_thread.cas_falhos++;
+    }
+}
+
+// Bytes ocupados por uma fila com capacidade slots (cabeçalho + slots)
+size_t tamanho_fila(int capacidade) {
+    return sizeof(FilaImpressao) + (size_t)capacidade * sizeof(SlotFila);
 }
 
-// Destroi a fila e libera recursos
+// Inicializa a fila de impressão em uma área de tamanho_fila(capacidade) bytes
+void inicializar_fila(FilaImpressao *fila, int capacidade) {
+    fila->capacidade = capacidade;
+    fila->inicio = 0;
+    fila->fim = 0;
+    fila->versao_itens = 0;
+    fila->esperando_itens = 0;
+    fila->versao_espacos = 0;
+    fila->esperando_espacos = 0;
+    fila->encerrada = 0;
+    
+    // Cada slot começa livre para a primeira volta
+    for (unsigned long long i = 0; i < fila->capacidade; i++) {
+        fila->slots[i].sequencia = i;
+    }
+}
+
+// Aloca e inicializa uma fila; NULL se falta memória
+FilaImpressao* criar_fila(int capacidade) {
+    void *memoria;
+    if (posix_memalign(&memoria, TAMANHO_LINHA_CACHE, tamanho_fila(capacidade)) != 0) {
+        return NULL;
+    }
+    inicializar_fila(memoria, capacidade);
+    return memoria;
+}
+
+// Destroi uma fila de criar_fila; trabalhos pendentes são descartados
 void destruir_fila(FilaImpressao *fila) {
-    pthread_mutex_lock(&fila->mutex);
+    free(fila);
+}
+
+// Enfileira um trabalho de impressão
+int enfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao trabalho) {
+    return enfileirar_lote(fila, &trabalho, 1) == 1 ? 0 : -1;
+}
+
+// Desenfileira um trabalho de impressão
+int desenfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao *trabalho) {
+    return desenfileirar_lote(fila, trabalho, 1) == 1 ? 0 : -1;
+}
+
+// Enfileira reservando o maior trecho livre do anel por vez e avisa cada parte
+// inserida no futex versao (o do próprio anel ou o das filas das impressoras).
+// Bloqueia até todos entrarem; retorna quantos entraram (menos se a fila for
+// encerrada ou, com timeout_ms >= 0, se o anel seguir cheio depois da espera).
+static int enfileirar_avisando(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade,
+                               unsigned int *versao_itens, unsigned int *esperando_itens,
+                               int timeout_ms) {
+    int enfileirados = 0;
+    int esperou = 0;
     
-    NoFila *atual = fila->inicio;
-    while (atual != NULL) {
-        NoFila *temp = atual;
-        atual = atual->proximo;
-        free(temp);
+    while (enfileirados < quantidade) {
+        // Fila encerrada recusa o restante, mesmo que ainda tenha espaço
+        if (__atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE)) break;
+        
+        int inseridos = tentar_enfileirar(fila, trabalhos + enfileirados, quantidade - enfileirados);
+        int encerrada = 0;
+        
+        if (inseridos == 0) {
+            if (esperou || timeout_ms == 0) break;     // Prazo esgotado sem espaço
+            
+            // Anel cheio: registra a espera e confere de novo antes de dormir
+            __atomic_add_fetch(&fila->esperando_espacos, 1, __ATOMIC_SEQ_CST);
+            unsigned int versao = __atomic_load_n(&fila->versao_espacos, __ATOMIC_ACQUIRE);
+            
+            inseridos = tentar_enfileirar(fila, trabalhos + enfileirados, quantidade - enfileirados);
+            encerrada = __atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE);
+            if (inseridos == 0 && !encerrada) {
+                contencao_thread.esperas_cheia++;
+                futex_esperar(&fila->versao_espacos, versao, timeout_ms);
+                esperou = timeout_ms >= 0;
+            }
+            
+            __atomic_sub_fetch(&fila->esperando_espacos, 1, __ATOMIC_SEQ_CST);
+        }
+        
+        if (inseridos > 0) {
+            // Sinaliza que há trabalhos disponíveis
+            sinalizar(versao_itens, esperando_itens, inseridos);
+            enfileirados += inseridos;
+            esperou = 0;
+        } else if (encerrada) {
+            break;
+        }
     }
     
-    fila->inicio = NULL;
-    fila->fim = NULL;
-    fila->tamanho = 0;
+    return enfileirados;
+}
+
+// Enfileira vários trabalhos, reservando o maior trecho livre do anel por vez.
+// Bloqueia até todos entrarem; retorna quantos entraram (menos se a fila for encerrada).
+int enfileirar_lote(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade) {
+    return enfileirar_avisando(fila, trabalhos, quantidade, &fila->versao_itens, &fila->esperando_itens, -1);
+}
+
+// Como enfileirar_lote, mas desiste depois de esperar timeout_ms por espaço sem
+// conseguir inserir; quem chama confere o que quiser e tenta de novo
+int enfileirar_lote_ate(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade,
+                        int timeout_ms) {
+    return enfileirar_avisando(fila, trabalhos, quantidade, &fila->versao_itens, &fila->esperando_itens,
+                               timeout_ms);
+}
+
+// Desenfileira até maximo trabalhos já disponíveis; bloqueia só enquanto o anel
+// estiver vazio. Retorna quantos retirou, ou -1 se a fila foi encerrada vazia.
+int desenfileirar_lote(FilaImpressao *fila, TrabalhoImpressao *trabalhos, int maximo) {
+    for (;;) {
+        int retirados = tentar_desenfileirar(fila, trabalhos, maximo);
+        int encerrada = 0;
+        
+        if (retirados == 0) {
+            // Anel vazio: registra a espera e confere de novo antes de dormir
+            __atomic_add_fetch(&fila->esperando_itens, 1, __ATOMIC_SEQ_CST);
+            unsigned int versao = __atomic_load_n(&fila->versao_itens, __ATOMIC_ACQUIRE);
+            
+            retirados = tentar_desenfileirar(fila, trabalhos, maximo);
+            encerrada = __atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE);
+            if (retirados == 0 && !encerrada) {
+                contencao_thread.esperas_vazia++;
+                futex_esperar(&fila->versao_itens, versao, -1);
+            }
+            
+            __atomic_sub_fetch(&fila->esperando_itens, 1, __ATOMIC_SEQ_CST);
+        }
+        
+        if (retirados > 0) {
+            // Sinaliza que há espaço disponível
+            sinalizar(&fila->versao_espacos, &fila->esperando_espacos, retirados);
+            return retirados;
+        }
+        if (encerrada) return -1;
+    }
+}
+
+// Contenção acumulada pela thread que chama, desde que ela começou
+void ler_contencao_fila(ContencaoFila *contencao) {
+    *contencao = contencao_thread;
+}
+
+// Acorda todas as threads bloqueadas; depois disso as inserções são recusadas e
+// a retirada devolve o que sobrou, e -1 com a fila vazia.
+// Só usa operações atômicas e futex, então pode ser chamada de um handler de sinal.
+void encerrar_fila(FilaImpressao *fila) {
+    __atomic_store_n(&fila->encerrada, 1, __ATOMIC_SEQ_CST);
+    
+    __atomic_add_fetch(&fila->versao_itens, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fila->versao_espacos, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&fila->versao_itens, INT_MAX);
+    futex_acordar(&fila->versao_espacos, INT_MAX);
+}
+
+// Cria num_filas anéis de capacidade trabalhos, todos ativos; -1 se falta memória
+int inicializar_filas_impressoras(FilasImpressoras *filas, int num_filas, int capacidade,
+                                  DistribuicaoFila distribuicao) {
+    memset(filas, 0, sizeof(*filas));
+    filas->num_filas = num_filas;
+    filas->ativas = num_filas;
+    filas->distribuicao = distribuicao;
+    for (int i = 0; i < num_filas; i++) {
+        filas->locais[i].fila = criar_fila(capacidade);
+        if (filas->locais[i].fila == NULL) {
+            destruir_filas_impressoras(filas);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void destruir_filas_impressoras(FilasImpressoras *filas) {
+    for (int i = 0; i < filas->num_filas; i++) {
+        destruir_fila(filas->locais[i].fila);
+        filas->locais[i].fila = NULL;
+        filas->locais[i].paginas_pendentes = 0;
+    }
+}
+
+// Escolhe a fila de destino de cada um de até LOTE_INGESTAO trabalhos entre as
+// ativas e enfileira cada grupo de uma vez, esperando até timeout_ms por espaço.
+// Anota o destino de cada trabalho e quantos entraram em cada fila (sempre os
+// primeiros do grupo). Retorna quantos entraram no total.
+static int distribuir_parte(FilasImpressoras *filas, const TrabalhoImpressao *trabalhos, int parte,
+                            int timeout_ms, unsigned char *destinos, int *inseridos_fila) {
+    TrabalhoImpressao agrupados[LOTE_INGESTAO];
+    int inicio_grupo[MAX_IMPRESSORAS + 1] = {0};
+    long long carga[MAX_IMPRESSORAS];
+    
+    int ativas = __atomic_load_n(&filas->ativas, __ATOMIC_RELAXED);
+    
+    // Menor carga: estimativa lida uma vez e atualizada localmente a cada escolha
+    for (int i = 0; i < ativas; i++) {
+        carga[i] = __atomic_load_n(&filas->locais[i].paginas_pendentes, __ATOMIC_RELAXED);
+    }
+    unsigned int rodizio = __atomic_fetch_add(&filas->proxima, parte, __ATOMIC_RELAXED);
+    
+    for (int j = 0; j < parte; j++) {
+        const TrabalhoImpressao *trabalho = &trabalhos[j];
+        int destino = (rodizio + j) % ativas;
+        if (filas->distribuicao == DISTRIBUICAO_MENOR_CARGA) {
+            for (int i = 0; i < ativas; i++) {
+                if (carga[i] < carga[destino]) destino = i;
+            }
+        }
+        carga[destino] += trabalho->numero_paginas;
+        destinos[j] = destino;
+        inicio_grupo[destino + 1]++;
+    }
     
-    pthread_mutex_unlock(&fila->mutex);
+    // Agrupa por destino, mantendo a ordem de chegada dentro de cada grupo
+    for (int i = 0; i < ativas; i++) {
+        inicio_grupo[i + 1] += inicio_grupo[i];
+    }
+    int posicao[MAX_IMPRESSORAS];
+    memcpy(posicao, inicio_grupo, sizeof(int) * ativas);
+    for (int j = 0; j < parte; j++) {
+        agrupados[posicao[destinos[j]]++] = trabalhos[j];
+    }
+    
+    int entraram = 0;
+    for (int i = 0; i < ativas; i++) {
+        const TrabalhoImpressao *grupo = agrupados + inicio_grupo[i];
+        int tamanho = inicio_grupo[i + 1] - inicio_grupo[i];
+        inseridos_fila[i] = 0;
+        if (tamanho == 0) continue;
+        
+        // A carga (e a conta do relógio virtual) sobe antes da inserção para
+        // nunca ficar negativa após um roubo
+        long long paginas = 0;
+        for (int j = 0; j < tamanho; j++) paginas += grupo[j].numero_paginas;
+        __atomic_add_fetch(&filas->locais[i].paginas_pendentes, paginas, __ATOMIC_RELAXED);
+        trabalhos_enfileirados(tamanho);
+        
+        // Cada parte inserida acorda impressoras ociosas, que podem roubá-la
+        // e liberar espaço enquanto a ingestão espera o anel cheio
+        int inseridos = enfileirar_avisando(filas->locais[i].fila, grupo, tamanho,
+                                            &filas->versao_itens, &filas->esperando_itens, timeout_ms);
+        if (inseridos < tamanho) {
+            long long recusadas = 0;
+            for (int j = inseridos; j < tamanho; j++) recusadas += grupo[j].numero_paginas;
+            __atomic_sub_fetch(&filas->locais[i].paginas_pendentes, recusadas, __ATOMIC_RELAXED);
+            trabalhos_enfileirados(inseridos - tamanho);
+        }
+        inseridos_fila[i] = inseridos;
+        entraram += inseridos;
+    }
     
-    // Destroi mutex e semáforos
-    pthread_mutex_destroy(&fila->mutex);
-    sem_destroy(&fila->vazio);
-    sem_destroy(&fila->cheio);
+    return entraram;
 }
 
-// Enfileira um trabalho de impressão
-int enfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao trabalho) {
-    // Espera por espaço disponível
-    sem_wait(&fila->cheio);
+// Distribui os trabalhos entre as filas ativas, bloqueando enquanto estiverem
+// cheias. Retorna quantos entraram (menos se as filas forem encerradas).
+int distribuir_lote(FilasImpressoras *filas, const TrabalhoImpressao *trabalhos, int quantidade) {
+    int enfileirados = 0;
     
-    pthread_mutex_lock(&fila->mutex);
+    while (enfileirados < quantidade) {
+        unsigned char destinos[LOTE_INGESTAO];
+        int inseridos_fila[MAX_IMPRESSORAS];
+        int parte = quantidade - enfileirados;
+        if (parte > LOTE_INGESTAO) parte = LOTE_INGESTAO;
+        
+        int entraram = distribuir_parte(filas, trabalhos + enfileirados, parte, -1, destinos, inseridos_fila);
+        enfileirados += entraram;
+        if (entraram < parte) break;    // Filas encerradas
+    }
     
-    // Cria novo nó
-    NoFila *novo_no = malloc(sizeof(NoFila));
-    if (novo_no == NULL) {
-        pthread_mutex_unlock(&fila->mutex);
-        sem_post(&fila->cheio); // Libera o semáforo que foi decrementado
-        return -1;
+    return enfileirados;
+}
+
+// Versão sem bloqueio de distribuir_lote, para até LOTE_INGESTAO trabalhos: insere
+// o que couber agora e reordena trabalhos com os que entraram na frente e os que
+// sobraram atrás, cada parte na ordem de chegada. Retorna quantos entraram.
+int tentar_distribuir_lote(FilasImpressoras *filas, TrabalhoImpressao *trabalhos, int quantidade) {
+    unsigned char destinos[LOTE_INGESTAO];
+    int inseridos_fila[MAX_IMPRESSORAS];
+    
+    int entraram = distribuir_parte(filas, trabalhos, quantidade, 0, destinos, inseridos_fila);
+    if (entraram == quantidade) return entraram;
+    
+    // Em cada fila entraram os primeiros do grupo: os demais vão para o fim
+    TrabalhoImpressao sobras[LOTE_INGESTAO];
+    int num_sobras = 0;
+    int posicao = 0;
+    for (int j = 0; j < quantidade; j++) {
+        if (inseridos_fila[destinos[j]] > 0) {
+            inseridos_fila[destinos[j]]--;
+            trabalhos[posicao++] = trabalhos[j];
+        } else {
+            sobras[num_sobras++] = trabalhos[j];
+        }
     }
+    memcpy(trabalhos + posicao, sobras, sizeof(TrabalhoImpressao) * num_sobras);
     
-    novo_no->trabalho = trabalho;
-    novo_no->proximo = NULL;
+    return entraram;
+}
+
+// Tenta retirar sem bloquear da fila local indice; libera espaço e desconta a carga
+static int tentar_retirar_de(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho) {
+    FilaLocal *local = &filas->locais[indice];
+    if (tentar_desenfileirar(local->fila, trabalho, 1) == 0) return 0;
     
-    // Adiciona à fila
-    if (fila->fim == NULL) {
-        fila->inicio = novo_no;
-        fila->fim = novo_no;
-    } else {
-        fila->fim->proximo = novo_no;
-        fila->fim = novo_no;
+    __atomic_sub_fetch(&local->paginas_pendentes, trabalho->numero_paginas, __ATOMIC_RELAXED);
+    sinalizar(&local->fila->versao_espacos, &local->fila->esperando_espacos, 1);
+    return 1;
+}
+
+// Retira da própria fila ou, se vazia, rouba um trabalho da próxima fila com trabalho.
+// Retorna 0 (própria fila), 1 (roubado) ou -1 se não há nada.
+static int tentar_retirar_ou_roubar(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho) {
+    if (tentar_retirar_de(filas, indice, trabalho)) return 0;
+    
+    for (int i = 1; i < filas->num_filas; i++) {
+        if (tentar_retirar_de(filas, (indice + i) % filas->num_filas, trabalho)) return 1;
     }
+    return -1;
+}
+
+// Retira o próximo trabalho da impressora indice, bloqueando enquanto todas as filas
+// estiverem vazias. Retorna 0 (própria fila), 1 (roubado de outra) ou -1 se as filas
+// foram encerradas ou a impressora foi desativada.
+int retirar_trabalho_local(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho) {
+    for (;;) {
+        if (indice >= __atomic_load_n(&filas->ativas, __ATOMIC_ACQUIRE)) return -1;
+        
+        int origem = tentar_retirar_ou_roubar(filas, indice, trabalho);
+        if (origem >= 0) return origem;
+        
+        // Todas vazias: registra a espera e confere de novo antes de dormir
+        __atomic_add_fetch(&filas->esperando_itens, 1, __ATOMIC_SEQ_CST);
+        unsigned int versao = __atomic_load_n(&filas->versao_itens, __ATOMIC_ACQUIRE);
+        
+        origem = tentar_retirar_ou_roubar(filas, indice, trabalho);
+        int encerrada = __atomic_load_n(&filas->encerrada, __ATOMIC_ACQUIRE);
+        if (origem < 0 && !encerrada && indice < __atomic_load_n(&filas->ativas, __ATOMIC_ACQUIRE)) {
+            futex_esperar(&filas->versao_itens, versao, -1);
+        }
+        
+        __atomic_sub_fetch(&filas->esperando_itens, 1, __ATOMIC_SEQ_CST);
+        
+        if (origem >= 0) return origem;
+        if (encerrada) return -1;
+    }
+}
+
+// Versão sem bloqueio de retirar_trabalho_local: -1 se não há trabalho agora
+int tentar_retirar_trabalho_local(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho) {
+    if (indice >= __atomic_load_n(&filas->ativas, __ATOMIC_ACQUIRE)) return -1;
+    return tentar_retirar_ou_roubar(filas, indice, trabalho);
+}
+
+// Muda quantas filas recebem trabalhos. As impressoras desativadas terminam o trabalho
+// atual e saem; as acordadas aqui roubam o que ficou nas filas delas.
+void definir_ativas_filas_impressoras(FilasImpressoras *filas, int ativas) {
+    __atomic_store_n(&filas->ativas, ativas, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&filas->versao_itens, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&filas->versao_itens, INT_MAX);
+}
+
+// Trabalhos e páginas à espera em todas as filas locais (leitura aproximada)
+void medir_filas_impressoras(FilasImpressoras *filas, int *trabalhos, long long *paginas) {
+    *trabalhos = 0;
+    *paginas = 0;
+    for (int i = 0; i < filas->num_filas; i++) {
+        FilaImpressao *fila = filas->locais[i].fila;
+        unsigned long long inicio = __atomic_load_n(&fila->inicio, __ATOMIC_RELAXED);
+        unsigned long long fim = __atomic_load_n(&fila->fim, __ATOMIC_RELAXED);
+        if (fim > inicio) *trabalhos += (int)(fim - inicio);
+        *paginas += __atomic_load_n(&filas->locais[i].paginas_pendentes, __ATOMIC_RELAXED);
+    }
+}
+
+// Encerra as filas locais (acordando a ingestão bloqueada) e as impressoras ociosas.
+// Só atômicos e futex: pode ser chamada de um handler de sinal.
+void encerrar_filas_impressoras(FilasImpressoras *filas) {
+    for (int i = 0; i < filas->num_filas; i++) {
+        encerrar_fila(filas->locais[i].fila);
+    }
+    
+    __atomic_store_n(&filas->encerrada, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&filas->versao_itens, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&filas->versao_itens, INT_MAX);
+}
+
+// Chave de ordenação: a classe do trabalho vale envelhecimento_ms de espera
+static long long chave_prioridade(const FilaPrioridade *fila, const TrabalhoImpressao *trabalho,
+                                  long long chegada_ms) {
+    long long classe = 0;
+    if (fila->politica == POLITICA_PRIORIDADE) {
+        classe = trabalho->prioridade;
+        if (classe < 0) classe = 0;
+        if (classe >= NUM_PRIORIDADES) classe = NUM_PRIORIDADES - 1;
+    } else if (fila->politica == POLITICA_SJF) {
+        classe = trabalho->numero_paginas > 0 ? trabalho->numero_paginas : 0;
+    }
+    return classe * fila->envelhecimento_ms + chegada_ms;
+}
+
+static int antes(const EntradaPrioridade *a, const EntradaPrioridade *b) {
+    return a->chave < b->chave || (a->chave == b->chave && a->ordem < b->ordem);
+}
+
+// Insere sob a trava até encher o heap. Retorna quantos inseriu (0 = cheio).
+static int tentar_enfileirar_prioridade(FilaPrioridade *fila, const TrabalhoImpressao *trabalhos,
+                                        int quantidade) {
+    // Chegada no relógio das impressoras, para o envelhecimento valer em tempo simulado
+    long long chegada_ms = relogio_impressao_ns() / 1000000;
     
-    fila->tamanho++;
+    pthread_mutex_lock(&fila->trava);
+    int inseridos = 0;
+    while (inseridos < quantidade && fila->tamanho < fila->capacidade) {
+        EntradaPrioridade entrada;
+        entrada.chave = chave_prioridade(fila, &trabalhos[inseridos], chegada_ms);
+        entrada.ordem = fila->proxima_ordem++;
+        entrada.trabalho = trabalhos[inseridos];
+        
+        // Sobe a partir da última posição
+        int i = fila->tamanho++;
+        while (i > 0 && antes(&entrada, &fila->heap[(i - 1) / 2])) {
+            fila->heap[i] = fila->heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        fila->heap[i] = entrada;
+        fila->paginas_pendentes += entrada.trabalho.numero_paginas;
+        inseridos++;
+    }
+    // Ainda sob a trava, antes que alguma impressora retire os inseridos
+    if (inseridos > 0) trabalhos_enfileirados(inseridos);
+    pthread_mutex_unlock(&fila->trava);
+    return inseridos;
+}
+
+// Retira sob a trava a entrada de menor chave. Retorna 0 com o heap vazio.
+static int tentar_desenfileirar_prioridade(FilaPrioridade *fila, TrabalhoImpressao *trabalho) {
+    pthread_mutex_lock(&fila->trava);
+    if (fila->tamanho == 0) {
+        pthread_mutex_unlock(&fila->trava);
+        return 0;
+    }
+    
+    *trabalho = fila->heap[0].trabalho;
+    fila->paginas_pendentes -= trabalho->numero_paginas;
+    EntradaPrioridade ultima = fila->heap[--fila->tamanho];
     
-    pthread_mutex_unlock(&fila->mutex);
+    // Desce a última entrada a partir da raiz
+    int i = 0;
+    for (;;) {
+        int filho = 2 * i + 1;
+        if (filho >= fila->tamanho) break;
+        if (filho + 1 < fila->tamanho && antes(&fila->heap[filho + 1], &fila->heap[filho])) {
+            filho++;
+        }
+        if (!antes(&fila->heap[filho], &ultima)) break;
+        fila->heap[i] = fila->heap[filho];
+        i = filho;
+    }
+    fila->heap[i] = ultima;
     
-    // Sinaliza que há um trabalho disponível
-    sem_post(&fila->vazio);
+    pthread_mutex_unlock(&fila->trava);
+    return 1;
+}
+
+// Inicializa o heap com capacidade trabalhos; -1 se falta memória
+int inicializar_fila_prioridade(FilaPrioridade *fila, PoliticaFila politica, int capacidade,
+                                int envelhecimento_ms) {
+    memset(fila, 0, sizeof(*fila));
+    fila->heap = malloc(sizeof(EntradaPrioridade) * capacidade);
+    if (fila->heap == NULL) return -1;
     
+    pthread_mutex_init(&fila->trava, NULL);
+    fila->politica = politica;
+    fila->capacidade = capacidade;
+    fila->envelhecimento_ms = envelhecimento_ms;
+    fila->ativas = MAX_IMPRESSORAS;
     return 0;
 }
 
-// Desenfileira um trabalho de impressão
-int desenfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao *trabalho) {
-    // Espera por trabalho disponível
-    sem_wait(&fila->vazio);
+void destruir_fila_prioridade(FilaPrioridade *fila) {
+    // Trabalhos pendentes são descartados, como no anel
+    pthread_mutex_destroy(&fila->trava);
+    free(fila->heap);
+    fila->heap = NULL;
+    fila->tamanho = 0;
+}
+
+// Enfileira vários trabalhos sob uma única trava enquanto houver espaço.
+// Bloqueia até todos entrarem; retorna quantos entraram (menos se a fila for encerrada).
+int enfileirar_lote_prioridade(FilaPrioridade *fila, const TrabalhoImpressao *trabalhos, int quantidade) {
+    int enfileirados = 0;
     
-    pthread_mutex_lock(&fila->mutex);
+    while (enfileirados < quantidade) {
+        if (__atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE)) break;
+        
+        int inseridos = tentar_enfileirar_prioridade(fila, trabalhos + enfileirados,
+                                                     quantidade - enfileirados);
+        int encerrada = 0;
+        
+        if (inseridos == 0) {
+            // Heap cheio: registra a espera e confere de novo antes de dormir
+            __atomic_add_fetch(&fila->esperando_espacos, 1, __ATOMIC_SEQ_CST);
+            unsigned int versao = __atomic_load_n(&fila->versao_espacos, __ATOMIC_ACQUIRE);
+            
+            inseridos = tentar_enfileirar_prioridade(fila, trabalhos + enfileirados,
+                                                     quantidade - enfileirados);
+            encerrada = __atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE);
+            if (inseridos == 0 && !encerrada) {
+                futex_esperar(&fila->versao_espacos, versao, -1);
+            }
+            
+            __atomic_sub_fetch(&fila->esperando_espacos, 1, __ATOMIC_SEQ_CST);
+        }
+        
+        if (inseridos > 0) {
+            sinalizar(&fila->versao_itens, &fila->esperando_itens, inseridos);
+            enfileirados += inseridos;
+        } else if (encerrada) {
+            break;
+        }
+    }
     
-    if (fila->inicio == NULL) {
-        pthread_mutex_unlock(&fila->mutex);
-        sem_post(&fila->vazio); // Libera o semáforo que foi decrementado
-        return -1;
+    return enfileirados;
+}
+
+// Versão sem bloqueio de enfileirar_lote_prioridade: insere os primeiros que
+// couberem no heap agora. Retorna quantos entraram.
+int tentar_enfileirar_lote_prioridade(FilaPrioridade *fila, const TrabalhoImpressao *trabalhos, int quantidade) {
+    if (__atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE)) return 0;
+    
+    int inseridos = tentar_enfileirar_prioridade(fila, trabalhos, quantidade);
+    if (inseridos > 0) {
+        sinalizar(&fila->versao_itens, &fila->esperando_itens, inseridos);
+    }
+    return inseridos;
+}
+
+// Retira o trabalho de menor chave para a impressora indice; bloqueia enquanto a
+// fila estiver vazia. Retorna -1 se a fila foi encerrada vazia ou a impressora desativada.
+int desenfileirar_prioridade(FilaPrioridade *fila, int indice, TrabalhoImpressao *trabalho) {
+    for (;;) {
+        if (indice >= __atomic_load_n(&fila->ativas, __ATOMIC_ACQUIRE)) return -1;
+        
+        int retirado = tentar_desenfileirar_prioridade(fila, trabalho);
+        int encerrada = 0;
+        
+        if (!retirado) {
+            // Heap vazio: registra a espera e confere de novo antes de dormir
+            __atomic_add_fetch(&fila->esperando_itens, 1, __ATOMIC_SEQ_CST);
+            unsigned int versao = __atomic_load_n(&fila->versao_itens, __ATOMIC_ACQUIRE);
+            
+            retirado = tentar_desenfileirar_prioridade(fila, trabalho);
+            encerrada = __atomic_load_n(&fila->encerrada, __ATOMIC_ACQUIRE);
+            if (!retirado && !encerrada && indice < __atomic_load_n(&fila->ativas, __ATOMIC_ACQUIRE)) {
+                futex_esperar(&fila->versao_itens, versao, -1);
+            }
+            
+            __atomic_sub_fetch(&fila->esperando_itens, 1, __ATOMIC_SEQ_CST);
+        }
+        
+        if (retirado) {
+            sinalizar(&fila->versao_espacos, &fila->esperando_espacos, 1);
+            return 0;
+        }
+        if (encerrada) return -1;
     }
+}
+
+// Versão sem bloqueio de desenfileirar_prioridade: -1 se não há trabalho agora
+int tentar_retirar_prioridade(FilaPrioridade *fila, int indice, TrabalhoImpressao *trabalho) {
+    if (indice >= __atomic_load_n(&fila->ativas, __ATOMIC_ACQUIRE)) return -1;
+    if (!tentar_desenfileirar_prioridade(fila, trabalho)) return -1;
     
-    // Remove o primeiro trabalho da fila
-    NoFila *no_removido = fila->inicio;
-    *trabalho = no_removido->trabalho;
+    sinalizar(&fila->versao_espacos, &fila->esperando_espacos, 1);
+    return 0;
+}
+
+// Como encerrar_fila: só atômicos e futex, seguro em handler de sinal
+void encerrar_fila_prioridade(FilaPrioridade *fila) {
+    __atomic_store_n(&fila->encerrada, 1, __ATOMIC_SEQ_CST);
     
-    fila->inicio = fila->inicio->proximo;
-    if (fila->inicio == NULL) {
-        fila->fim = NULL;
+    __atomic_add_fetch(&fila->versao_itens, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fila->versao_espacos, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&fila->versao_itens, INT_MAX);
+    futex_acordar(&fila->versao_espacos, INT_MAX);
+}
+
+// Muda quantas impressoras retiram do heap; as desativadas saem da espera
+void definir_ativas_fila_prioridade(FilaPrioridade *fila, int ativas) {
+    __atomic_store_n(&fila->ativas, ativas, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fila->versao_itens, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&fila->versao_itens, INT_MAX);
+}
+
+// Trabalhos e páginas à espera no heap
+void medir_fila_prioridade(FilaPrioridade *fila, int *trabalhos, long long *paginas) {
+    pthread_mutex_lock(&fila->trava);
+    *trabalhos = fila->tamanho;
+    *paginas = fila->paginas_pendentes;
+    pthread_mutex_unlock(&fila->trava);
+}
+
+// Cria (ou recria) o segmento compartilhado e inicializa o anel de submissão
+// com capacidade trabalhos
+MemoriaCompartilhada* criar_memoria_compartilhada(int capacidade) {
+    // Remove segmento de uma execução anterior, que pode ter outro tamanho
+    int shm_id = shmget(CHAVE_SHM, 0, 0);
+    if (shm_id != -1) {
+        shmctl(shm_id, IPC_RMID, NULL);
     }
     
-    fila->tamanho--;
-    free(no_removido);
+    shm_id = shmget(CHAVE_SHM, sizeof(MemoriaCompartilhada) + tamanho_fila(capacidade),
+                    IPC_CREAT | IPC_EXCL | 0666);
+    if (shm_id == -1) {
+        perror("Erro ao criar memória compartilhada");
+        return NULL;
+    }
     
-    pthread_mutex_unlock(&fila->mutex);
+    MemoriaCompartilhada *memoria = shmat(shm_id, NULL, 0);
+    if (memoria == (void *)-1) {
+        perror("Erro ao anexar memória compartilhada");
+        shmctl(shm_id, IPC_RMID, NULL);
+        return NULL;
+    }
     
-    // Sinaliza que há espaço disponível
-    sem_post(&fila->cheio);
+    // O anel só usa atômicos e futex não privados, válidos entre processos
+    inicializar_fila(fila_compartilhada(memoria), capacidade);
+    memoria->pid_servidor = getpid();
+    __atomic_store_n(&memoria->servidor_ativo, 1, __ATOMIC_RELEASE);
+    return memoria;
+}
+
+// Anexa o segmento criado pelo servidor; NULL se não existe ou o servidor parou
+MemoriaCompartilhada* anexar_memoria_compartilhada(void) {
+    // Tamanho 0: o cliente aceita a capacidade que o servidor escolheu
+    int shm_id = shmget(CHAVE_SHM, 0, 0);
+    if (shm_id == -1) {
+        return NULL;
+    }
     
-    return 0;
+    MemoriaCompartilhada *memoria = shmat(shm_id, NULL, 0);
+    if (memoria == (void *)-1) {
+        return NULL;
+    }
+    
+    if (!servidor_memoria_vivo(memoria)) {
+        shmdt(memoria);
+        return NULL;
+    }
+    return memoria;
+}
+
+// O servidor dono do segmento ainda aceita trabalhos: a marca servidor_ativo
+// só cai num encerramento normal, então também confere se o processo existe
+int servidor_memoria_vivo(MemoriaCompartilhada *memoria) {
+    if (!__atomic_load_n(&memoria->servidor_ativo, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    // EPERM: o processo existe, mas é de outro usuário
+    return kill(memoria->pid_servidor, 0) == 0 || errno == EPERM;
+}
+
+// Anel de submissão, logo após o cabeçalho no segmento
+FilaImpressao* fila_compartilhada(MemoriaCompartilhada *memoria) {
+    return (FilaImpressao *)(memoria + 1);
+}
+
+// Desanexa o segmento; o servidor também o marca para remoção
+void liberar_memoria_compartilhada(MemoriaCompartilhada *memoria, int remover) {
+    if (memoria == NULL) return;
+    
+    if (remover) {
+        int shm_id = shmget(CHAVE_SHM, 0, 0);
+        if (shm_id != -1) {
+            shmctl(shm_id, IPC_RMID, NULL);
+        }
+    }
+    shmdt(memoria);
 }
 
-// Simula a impressão de um trabalho
-void imprimir_trabalho(TrabalhoImpressao trabalho, int id_impressora) {
+// Simula a impressão de um trabalho. Retorna -1 se ela foi abortada (o
+// trabalho não conta como impresso e continua pendente no diário).
+int imprimir_trabalho(TrabalhoImpressao trabalho, int id_impressora) {
     char evento[256];
     
     snprintf(evento, sizeof(evento), 
@@ -116,34 +802,24 @@ void imprimir_trabalho(TrabalhoImpressao trabalho, int id_impressora) {
              id_impressora, trabalho.id_job, trabalho.nome_arquivo, trabalho.numero_paginas);
     log_evento(evento);
     
-    // Simula tempo de impressão (1 segundo por página)
-    sleep(trabalho.numero_paginas);
+    long long inicio_ns = relogio_impressao_ns();
+    metricas_inicio_impressao(id_impressora, trabalho.recebido_ns, inicio_ns);
+    
+    // Simula tempo de impressão (1 segundo por página, no tempo do backend), interrompível
+    if (simular_impressao(id_impressora - 1, trabalho.numero_paginas) != 0) {
+        metricas_impressao_interrompida(id_impressora, inicio_ns, relogio_impressao_ns());
+        snprintf(evento, sizeof(evento), "Impressora %d interrompeu impressão - ID: %d",
+                 id_impressora, trabalho.id_job);
+        log_evento(evento);
+        return -1;
+    }
+    
+    metricas_fim_impressao(id_impressora, trabalho.numero_paginas, trabalho.recebido_ns,
+                           inicio_ns, relogio_impressao_ns());
     
     snprintf(evento, sizeof(evento), 
              "Impressora %d finalizou impressão - ID: %d status_code::val-del-378",
              id_impressora, trabalho.id_job);
     log_evento(evento);
+    return 0;
 }
-
-// Registra evento no arquivo de log
-void log_evento(const char *evento) {
-    static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
-    
-    pthread_mutex_lock(&log_mutex);
-    
-    FILE *arquivo_log = fopen("log_servidor.txt", "a");
-    if (arquivo_log != NULL) {
-        time_t tempo_atual;
-        struct tm *info_tempo;
-        char timestamp[80];
-        
-        time(&tempo_atual);
-        info_tempo = localtime(&tempo_atual);
-        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", info_tempo);
-        
-        fprintf(arquivo_log, "[%s] %s\n", timestamp, evento);
-        fclose(arquivo_log);
-    }
-    
-    pthread_mutex_unlock(&log_mutex);
-}
\ No newline at end of file
@@ -3,7 +3,6 @@
 
 #define _DEFAULT_SOURCE  // Para usleep
 #include <pthread.h>
-#include <semaphore.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,48 +12,184 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <time.h>
+#include "log.h"
+#include "metricas.h"
+#include "impressora.h"
 
-#define MAX_TRABALHOS 100
-#define MAX_IMPRESSORAS 5
+#define CAPACIDADE_PADRAO 100   // Trabalhos por anel (--capacidade)
+#define IMPRESSORAS_PADRAO 5    // Tamanho do pool (--impressoras)
+#define MAX_IMPRESSORAS 64      // Limite do pool, inclusive com --autoescala
 #define NOME_ARQUIVO_MAX 50
 #define NOME_PIPE "/tmp/spooler_pipe"
+#define NOME_SOCKET "/tmp/spooler.sock"
 #define CHAVE_SHM 12345
+#define TAMANHO_LINHA_CACHE 64
+#define LOTE_INGESTAO 1024      // Registros por leitura na ingestão do servidor
+#define EVENTOS_EPOLL 64
+#define LIMITE_CONFIRMACOES 65536   // Confirmações acumuladas antes de parar de ler o cliente
+#define JANELA_CONFIRMACOES 4096    // Trabalhos sem confirmação que um cliente mantém em trânsito
+#define NUM_PRIORIDADES 3
+#define PRIORIDADE_ALTA 0
+#define PRIORIDADE_NORMAL 1
+#define PRIORIDADE_BAIXA 2
+#define CAPACIDADE_PRIORIDADE_PADRAO 4096   // A prioridade só reordena o que já está na fila
+#define ENVELHECIMENTO_PADRAO_MS 5000   // Espera que compensa um nível de prioridade (ou uma página no SJF)
+#define AUTOESCALA_INTERVALO_MS 1000    // Período de medição da autoescala
+#define AUTOESCALA_ESPERA_MAX_MS 5000   // Espera estimada que adiciona uma impressora
+#define AUTOESCALA_PERIODOS_OCIOSOS 3   // Períodos sem fila antes de retirar uma impressora
 
 // Estrutura do trabalho de impressão conforme especificado
 typedef struct {
     int id_job;
     char nome_arquivo[NOME_ARQUIVO_MAX];
     int numero_paginas;
+    int prioridade;     // PRIORIDADE_ALTA (0) a PRIORIDADE_BAIXA; só usada pela política de prioridade
+    long long recebido_ns;  // Instante da recepção (instante_ns), preenchido pelo servidor
 } TrabalhoImpressao;
 
-// Nó da fila
-typedef struct NoFila {
+// Confirmação enviada pelo servidor para cada trabalho recebido pelo socket
+typedef struct {
+    int id_cliente;     // ID que o cliente colocou no trabalho
+    int id_job;         // ID atribuído pelo servidor
+    int status;         // 0 = enfileirado, -1 = recusado
+} ConfirmacaoTrabalho;
+
+// Posição do anel: a sequência diz se o slot está livre ou ocupado
+// (algoritmo de Vyukov); cada slot ocupa sua própria linha de cache
+typedef struct {
+    unsigned long long sequencia;
     TrabalhoImpressao trabalho;
-    struct NoFila *proximo;
-} NoFila;
+} __attribute__((aligned(TAMANHO_LINHA_CACHE))) SlotFila;
 
-// Estrutura da fila de impressão
+// Estrutura da fila de impressão: anel sem lock, com a capacidade escolhida na
+// criação e os slots alocados logo após o cabeçalho (tamanho_fila).
+// Produtores e consumidores só dormem (futex) com o anel cheio ou vazio.
 typedef struct {
-    NoFila *inicio;
-    NoFila *fim;
-    int tamanho;
-    pthread_mutex_t mutex;
-    sem_t vazio;    // Semáforo para trabalhos disponíveis
-    sem_t cheio;    // Semáforo para espaços disponíveis
+    unsigned long long inicio __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Próxima posição a retirar
+    unsigned long long fim __attribute__((aligned(TAMANHO_LINHA_CACHE)));    // Próxima posição a inserir
+    unsigned int versao_itens __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Futex: muda a cada inserção
+    unsigned int esperando_itens;    // Consumidores dormindo no anel vazio
+    unsigned int versao_espacos __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Futex: muda a cada retirada
+    unsigned int esperando_espacos;  // Produtores dormindo no anel cheio
+    int encerrada;                   // Acorda todos e recusa novas esperas
+    unsigned int capacidade;
+    SlotFila slots[];
 } FilaImpressao;
 
-// Estrutura para memória compartilhada
+// Contenção vista pela thread atual nos anéis (só os caminhos lentos contam)
+typedef struct {
+    unsigned long long cas_falhos;      // Reservas perdidas para outra thread (CAS ou slot já tomado)
+    unsigned long long esperas_cheia;   // Vezes que um produtor dormiu com o anel cheio
+    unsigned long long esperas_vazia;   // Vezes que um consumidor dormiu com o anel vazio
+} ContencaoFila;
+
+// Como a ingestão escolhe a fila local de cada trabalho
+typedef enum { DISTRIBUICAO_RODIZIO, DISTRIBUICAO_MENOR_CARGA } DistribuicaoFila;
+
+// Fila local de uma impressora; a carga (páginas pendentes) fica em sua própria linha de cache
+typedef struct {
+    FilaImpressao *fila;
+    long long paginas_pendentes __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+} FilaLocal;
+
+// Filas das impressoras na política FIFO: um anel por impressora, alimentado
+// pela ingestão. Cada impressora retira da sua e, ociosa, rouba das outras;
+// só dorme (futex) quando todas estão vazias. Só as primeiras `ativas` filas
+// recebem trabalhos; as impressoras além delas saem e suas filas são roubadas.
+typedef struct {
+    FilaLocal locais[MAX_IMPRESSORAS];
+    int num_filas;
+    DistribuicaoFila distribuicao;
+    unsigned int proxima __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Rodízio
+    int ativas;                     // Impressoras em uso (as demais saem da espera)
+    unsigned int versao_itens __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Futex: muda a cada distribuição
+    unsigned int esperando_itens;   // Impressoras dormindo com todas as filas vazias
+    int encerrada;
+} FilasImpressoras;
+
+// Ordem em que as impressoras retiram os trabalhos, escolhida na partida do servidor
+typedef enum { POLITICA_FIFO, POLITICA_PRIORIDADE, POLITICA_SJF } PoliticaFila;
+
+// Trabalho na fila com prioridade: sai primeiro a menor chave
+typedef struct {
+    long long chave;            // Classe * envelhecimento_ms + chegada (ms)
+    unsigned long long ordem;   // Desempate pela ordem de chegada
+    TrabalhoImpressao trabalho;
+} EntradaPrioridade;
+
+// Fila das impressoras para as políticas de prioridade e SJF: heap protegido
+// por mutex, com a mesma espera via futex do anel. A classe (prioridade ou
+// páginas) vale envelhecimento_ms de espera, então nenhum trabalho espera
+// indefinidamente e a chave não muda enquanto ele está na fila.
+typedef struct {
+    pthread_mutex_t trava;
+    PoliticaFila politica;
+    long long envelhecimento_ms;
+    unsigned long long proxima_ordem;
+    int tamanho;
+    int capacidade;
+    long long paginas_pendentes;
+    int ativas;                      // Impressoras com índice >= ativas saem da espera
+    unsigned int versao_itens;       // Futex: muda a cada inserção
+    unsigned int esperando_itens;
+    unsigned int versao_espacos;     // Futex: muda a cada retirada
+    unsigned int esperando_espacos;
+    int encerrada;
+    EntradaPrioridade *heap;
+} FilaPrioridade;
+
+// Cabeçalho da memória compartilhada (System V, chave CHAVE_SHM): canal de
+// submissão em que os clientes enfileiram direto no anel que vem logo depois
+// do cabeçalho no segmento (fila_compartilhada). Os trabalhos no anel ainda
+// não passaram pelo diário nem recebem confirmação: se o servidor morrer,
+// eles se perdem.
 typedef struct {
-    FilaImpressao fila;
     int servidor_ativo;
-} MemoriaCompartilhada;
+    pid_t pid_servidor;     // Conferido pelos clientes: a marca acima não cai se o servidor morrer
+} __attribute__((aligned(TAMANHO_LINHA_CACHE))) MemoriaCompartilhada;
 
 // Protótipos das funções
-void inicializar_fila(FilaImpressao *fila);
+size_t tamanho_fila(int capacidade);
+void inicializar_fila(FilaImpressao *fila, int capacidade);
+FilaImpressao* criar_fila(int capacidade);
 void destruir_fila(FilaImpressao *fila);
 int enfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao trabalho);
 int desenfileirar_trabalho(FilaImpressao *fila, TrabalhoImpressao *trabalho);
-void imprimir_trabalho(TrabalhoImpressao trabalho, int id_impressora);
-void log_evento(const char *evento);
+int enfileirar_lote(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade);
+int enfileirar_lote_ate(FilaImpressao *fila, const TrabalhoImpressao *trabalhos, int quantidade,
+                        int timeout_ms);
+int desenfileirar_lote(FilaImpressao *fila, TrabalhoImpressao *trabalhos, int maximo);
+void encerrar_fila(FilaImpressao *fila);
+void ler_contencao_fila(ContencaoFila *contencao);
+int inicializar_filas_impressoras(FilasImpressoras *filas, int num_filas, int capacidade,
+                                  DistribuicaoFila distribuicao);
+void destruir_filas_impressoras(FilasImpressoras *filas);
+int distribuir_lote(FilasImpressoras *filas, const TrabalhoImpressao *trabalhos, int quantidade);
+int tentar_distribuir_lote(FilasImpressoras *filas, TrabalhoImpressao *trabalhos, int quantidade);
+int retirar_trabalho_local(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho);
+int tentar_retirar_trabalho_local(FilasImpressoras *filas, int indice, TrabalhoImpressao *trabalho);
+void encerrar_filas_impressoras(FilasImpressoras *filas);
+void definir_ativas_filas_impressoras(FilasImpressoras *filas, int ativas);
+void medir_filas_impressoras(FilasImpressoras *filas, int *trabalhos, long long *paginas);
+int inicializar_fila_prioridade(FilaPrioridade *fila, PoliticaFila politica, int capacidade,
+                                int envelhecimento_ms);
+void destruir_fila_prioridade(FilaPrioridade *fila);
+int enfileirar_lote_prioridade(FilaPrioridade *fila, const TrabalhoImpressao *trabalhos, int quantidade);
+int tentar_enfileirar_lote_prioridade(FilaPrioridade *fila, const TrabalhoImpressao *trabalhos, int quantidade);
+int desenfileirar_prioridade(FilaPrioridade *fila, int indice, TrabalhoImpressao *trabalho);
+int tentar_retirar_prioridade(FilaPrioridade *fila, int indice, TrabalhoImpressao *trabalho);
+void encerrar_fila_prioridade(FilaPrioridade *fila);
+void definir_ativas_fila_prioridade(FilaPrioridade *fila, int ativas);
+void medir_fila_prioridade(FilaPrioridade *fila, int *trabalhos, long long *paginas);
+MemoriaCompartilhada* criar_memoria_compartilhada(int capacidade);
+FilaImpressao* fila_compartilhada(MemoriaCompartilhada *memoria);
+MemoriaCompartilhada* anexar_memoria_compartilhada(void);
+int servidor_memoria_vivo(MemoriaCompartilhada *memoria);
+void liberar_memoria_compartilhada(MemoriaCompartilhada *memoria, int remover);
+int imprimir_trabalho(TrabalhoImpressao trabalho, int id_impressora);
+
+// Espera e despertar via futex (também usados pelo log)
+void futex_esperar(unsigned int *endereco, unsigned int valor, int timeout_ms);
+void futex_acordar(unsigned int *endereco, int quantidade);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "fila.h"
+#include <limits.h>
+
+// Backend de tempo das impressoras: cada modo define o relógio (tempo
+// simulado, usado pelas métricas) e como passa uma impressão de N páginas
+typedef struct {
+    const char *nome;
+    long long (*agora_ns)(void);
+    int (*esperar)(int indice, int paginas);    // -1 se abortada
+    void (*entrar)(int indice);                 // A impressora volta a ter trabalho
+    void (*ociosa)(int indice);                 // A impressora vai esperar trabalho
+    void (*sair)(int indice);                   // A impressora terminou
+    void (*enfileirados)(int quantidade);       // Trabalhos que entraram nas filas (negativo: saíram)
+    long long (*ns_por_pagina)(void);           // Espera real por página; 0 sem espera
+} BackendImpressora;
+
+// Futex: vira 1 quando o servidor aborta as impressões em andamento
+static unsigned int impressao_abortada = 0;
+
+// Tempo escalado: ns reais por página e a conversão para o tempo simulado
+static long long ns_por_pagina_escalado = US_POR_PAGINA_ESCALADO_PADRAO * 1000LL;
+static long long base_escalado_ns = 0;
+
+// Relógio virtual (simulação de eventos discretos): as impressoras com
+// trabalho registram o instante em que terminam; quando todas estão
+// esperando, o relógio salta para o menor desses instantes. Uma impressora
+// sem trabalho sai da conta (impressora_ociosa) e volta na próxima impressão.
+// Enquanto houver trabalho por iniciar e impressora ociosa, o relógio também
+// não anda: a ociosa foi acordada e vai começá-lo no instante atual.
+static struct {
+    pthread_mutex_t trava;
+    pthread_cond_t avancou;
+    long long agora_ns;
+    int participantes;                  // Impressoras que seguram o relógio
+    int esperando;                      // Participantes parados num alarme
+    int ociosas;                        // Impressoras esperando trabalho
+    long long por_iniciar;              // Trabalhos nas filas ou retirados e ainda não iniciados
+    int participa[MAX_IMPRESSORAS];
+    int ociosa[MAX_IMPRESSORAS];
+    long long alarmes[MAX_IMPRESSORAS]; // Fim da impressão atual; -1 sem alarme
+} relogio_virtual = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, 0, { 0 }, { 0 }, { 0 } };
+
+// Espera real de duracao_ns, interrompida por abortar_impressoes
+static int esperar_com_aborto(long long duracao_ns) {
+    long long fim_ns = instante_ns() + duracao_ns;
+    
+    for (;;) {
+        if (impressoes_abortadas()) return -1;
+        long long restante_ns = fim_ns - instante_ns();
+        if (restante_ns <= 0) return 0;
+        futex_esperar(&impressao_abortada, 0, (int)((restante_ns + 999999) / 1000000));
+    }
+}
+
+static void nada(int indice) {
+    (void)indice;
+}
+
+static void nada_enfileirados(int quantidade) {
+    (void)quantidade;
+}
+
+static long long ns_por_pagina_real(void) {
+    return NS_POR_PAGINA_REAL;
+}
+
+static int esperar_real(int indice, int paginas) {
+    (void)indice;
+    return esperar_com_aborto(paginas * NS_POR_PAGINA_REAL);
+}
+
+static long long ns_por_pagina_escalado_atual(void) {
+    return ns_por_pagina_escalado;
+}
+
+static long long agora_escalado(void) {
+    return (long long)((double)(instante_ns() - base_escalado_ns) * NS_POR_PAGINA_REAL / ns_por_pagina_escalado);
+}
+
+static int esperar_escalado(int indice, int paginas) {
+    (void)indice;
+    return esperar_com_aborto(paginas * ns_por_pagina_escalado);
+}
+
+static long long agora_virtual(void) {
+    pthread_mutex_lock(&relogio_virtual.trava);
+    long long agora = relogio_virtual.agora_ns;
+    pthread_mutex_unlock(&relogio_virtual.trava);
+    return agora;
+}
+
+// Com todos os participantes esperando, avança até o alarme mais próximo (com a trava)
+static void avancar_relogio(void) {
+    if (relogio_virtual.esperando == 0 || relogio_virtual.esperando < relogio_virtual.participantes) return;
+    if (relogio_virtual.por_iniciar > 0 && relogio_virtual.ociosas > 0) return;
+    
+    long long proximo = LLONG_MAX;
+    for (int i = 0; i < MAX_IMPRESSORAS; i++) {
+        if (relogio_virtual.alarmes[i] >= 0 && relogio_virtual.alarmes[i] < proximo) {
+            proximo = relogio_virtual.alarmes[i];
+        }
+    }
+    if (proximo > relogio_virtual.agora_ns) relogio_virtual.agora_ns = proximo;
+    pthread_cond_broadcast(&relogio_virtual.avancou);
+}
+
+// Marca a impressora como ociosa ou não (com a trava)
+static void marcar_ociosa(int indice, int ociosa) {
+    if (relogio_virtual.ociosa[indice] != ociosa) {
+        relogio_virtual.ociosa[indice] = ociosa;
+        relogio_virtual.ociosas += ociosa ? 1 : -1;
+    }
+}
+
+static void entrar_virtual(int indice) {
+    pthread_mutex_lock(&relogio_virtual.trava);
+    marcar_ociosa(indice, 0);
+    if (!relogio_virtual.participa[indice]) {
+        relogio_virtual.participa[indice] = 1;
+        relogio_virtual.participantes++;
+    }
+    pthread_mutex_unlock(&relogio_virtual.trava);
+}
+
+// Deixa a conta dos participantes: ociosa à espera de trabalho ou de vez
+static void deixar_relogio(int indice, int ociosa) {
+    pthread_mutex_lock(&relogio_virtual.trava);
+    marcar_ociosa(indice, ociosa);
+    if (relogio_virtual.participa[indice]) {
+        relogio_virtual.participa[indice] = 0;
+        relogio_virtual.participantes--;
+    }
+    avancar_relogio();
+    pthread_mutex_unlock(&relogio_virtual.trava);
+}
+
+static void ociosa_virtual(int indice) {
+    deixar_relogio(indice, 1);
+}
+
+static void sair_virtual(int indice) {
+    deixar_relogio(indice, 0);
+}
+
+static void enfileirados_virtual(int quantidade) {
+    pthread_mutex_lock(&relogio_virtual.trava);
+    relogio_virtual.por_iniciar += quantidade;
+    if (quantidade < 0) avancar_relogio();
+    pthread_mutex_unlock(&relogio_virtual.trava);
+}
+
+static int esperar_virtual(int indice, int paginas) {
+    entrar_virtual(indice);
+    
+    pthread_mutex_lock(&relogio_virtual.trava);
+    long long fim_ns = relogio_virtual.agora_ns + paginas * NS_POR_PAGINA_REAL;
+    relogio_virtual.por_iniciar--;
+    relogio_virtual.alarmes[indice] = fim_ns;
+    relogio_virtual.esperando++;
+    avancar_relogio();
+    
+    while (relogio_virtual.agora_ns < fim_ns && !impressoes_abortadas()) {
+        pthread_cond_wait(&relogio_virtual.avancou, &relogio_virtual.trava);
+    }
+    
+    relogio_virtual.alarmes[indice] = -1;
+    relogio_virtual.esperando--;
+    pthread_mutex_unlock(&relogio_virtual.trava);
+    
+    return impressoes_abortadas() ? -1 : 0;
+}
+
+static long long sem_espera(void) {
+    return 0;
+}
+
+static const BackendImpressora backend_real = { "real", instante_ns, esperar_real, nada, nada, nada,
+                                                nada_enfileirados, ns_por_pagina_real };
+static const BackendImpressora backend_escalado = { "escalado", agora_escalado, esperar_escalado, nada, nada,
+                                                    nada, nada_enfileirados, ns_por_pagina_escalado_atual };
+static const BackendImpressora backend_virtual = { "virtual", agora_virtual, esperar_virtual, entrar_virtual,
+                                                   ociosa_virtual, sair_virtual, enfileirados_virtual,
+                                                   sem_espera };
+
+static const BackendImpressora *backend = &backend_real;
+
+// Escolhe o backend antes de criar as impressoras. us_por_pagina só vale no
+// tempo escalado (0 = padrão).
+int configurar_impressoras(ModoTempo modo, long long us_por_pagina) {
+    switch (modo) {
+    case TEMPO_REAL:
+        backend = &backend_real;
+        break;
+    case TEMPO_ESCALADO:
+        if (us_por_pagina < 0) return -1;
+        ns_por_pagina_escalado = (us_por_pagina ? us_por_pagina : US_POR_PAGINA_ESCALADO_PADRAO) * 1000LL;
+        base_escalado_ns = instante_ns();
+        backend = &backend_escalado;
+        break;
+    case TEMPO_VIRTUAL:
+        for (int i = 0; i < MAX_IMPRESSORAS; i++) {
+            relogio_virtual.alarmes[i] = -1;
+        }
+        backend = &backend_virtual;
+        break;
+    default:
+        return -1;
+    }
+    return 0;
+}
+
+const char *nome_modo_tempo(void) {
+    return backend->nome;
+}
+
+// Relógio do tempo simulado: igual ao monotônico no modo real
+long long relogio_impressao_ns(void) {
+    return backend->agora_ns();
+}
+
+// Tempo real que uma página ocupa a impressora no modo atual (0 no virtual)
+long long ns_por_pagina_impressao(void) {
+    return backend->ns_por_pagina();
+}
+
+// Passa o tempo de impressão de paginas; retorna -1 se foi abortada
+int simular_impressao(int indice, int paginas) {
+    return backend->esperar(indice, paginas);
+}
+
+// Ciclo de vida da thread impressora indice, para o relógio virtual
+void impressora_iniciada(int indice) {
+    backend->entrar(indice);
+}
+
+// Chamada antes de a impressora bloquear na fila vazia
+void impressora_ociosa(int indice) {
+    backend->ociosa(indice);
+}
+
+void impressora_finalizada(int indice) {
+    backend->sair(indice);
+}
+
+// Chamada pelas filas das impressoras antes de inserir quantidade trabalhos e,
+// com negativo, para descontar os recusados
+void trabalhos_enfileirados(int quantidade) {
+    backend->enfileirados(quantidade);
+}
+
+// Interrompe todas as impressões em andamento e as próximas
+void abortar_impressoes(void) {
+    __atomic_store_n(&impressao_abortada, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&impressao_abortada, INT_MAX);
+    
+    pthread_mutex_lock(&relogio_virtual.trava);
+    pthread_cond_broadcast(&relogio_virtual.avancou);
+    pthread_mutex_unlock(&relogio_virtual.trava);
+}
+
+int impressoes_abortadas(void) {
+    return __atomic_load_n(&impressao_abortada, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,27 @@
+#ifndef IMPRESSORA_H
+#define IMPRESSORA_H
+
+#define NS_POR_PAGINA_REAL 1000000000LL         // 1 segundo por página
+#define US_POR_PAGINA_ESCALADO_PADRAO 1000      // --tempo escalado: 1 página = 1 ms
+
+// Como as impressoras simulam o tempo de impressão
+typedef enum {
+    TEMPO_REAL,         // Espera real de 1 s por página
+    TEMPO_ESCALADO,     // Espera real de --pagina-us por página; o relógio mostra o tempo simulado
+    TEMPO_VIRTUAL       // Sem espera: relógio virtual que avança até o próximo fim de impressão
+} ModoTempo;
+
+// Protótipos das funções
+int configurar_impressoras(ModoTempo modo, long long us_por_pagina);
+const char *nome_modo_tempo(void);
+long long relogio_impressao_ns(void);
+long long ns_por_pagina_impressao(void);
+int simular_impressao(int indice, int paginas);
+void impressora_iniciada(int indice);
+void impressora_ociosa(int indice);
+void impressora_finalizada(int indice);
+void trabalhos_enfileirados(int quantidade);
+void abortar_impressoes(void);
+int impressoes_abortadas(void);
+
+#endif
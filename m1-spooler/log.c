@@ -0,0 +1,343 @@
+#include "fila.h"
+#include <fcntl.h>
+#include <limits.h>
+
+#define SEM_PENDENTE ULLONG_MAX     // Nenhuma linha sendo escrita no buffer
+
+// Cabeçalho de cada linha no buffer: a sequência global ordena os eventos
+// de threads diferentes na hora da descarga
+typedef struct {
+    unsigned long long sequencia;
+    size_t tamanho;
+} CabecalhoLinha;
+
+// Buffer circular de uma thread: a thread escreve, o escritor do log lê.
+// Os buffers nunca são liberados antes de finalizar_log; o de uma thread
+// que terminou é reaproveitado por outra depois de esvaziado.
+typedef struct BufferLog {
+    char dados[LOG_TAMANHO_BUFFER];
+    unsigned long long escrito __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Avançado pela thread dona
+    unsigned long long pendente;    // Limite inferior da sequência da linha em escrita
+    unsigned int esperando;         // A dona dorme com o buffer cheio
+    unsigned long long lido __attribute__((aligned(TAMANHO_LINHA_CACHE)));    // Avançado pelo escritor
+    unsigned int versao_lido;       // Futex: muda quando lido avança com a dona esperando
+    int abandonado;             // A thread dona terminou
+    struct BufferLog *proximo;
+} BufferLog;
+
+// Estado do log assíncrono
+static struct {
+    int fd;
+    int intervalo_ms;
+    int ativo;
+    int encerrando;
+    unsigned int despertar;     // Futex: pede uma descarga antecipada
+    unsigned long long sequencia; // Próximo número de evento
+    BufferLog *buffers;         // Lista só cresce; leitura sem lock
+    pthread_mutex_t mutex_registro;
+    pthread_key_t chave_thread;
+    pthread_t escritor;
+} log_global = { -1, LOG_INTERVALO_PADRAO_MS, 0, 0, 0, 0, NULL,
+                 PTHREAD_MUTEX_INITIALIZER, 0, 0 };
+
+// Buffer e cache do timestamp de cada thread (o timestamp muda uma vez por segundo)
+static __thread BufferLog *buffer_thread = NULL;
+static __thread time_t segundo_cache = -1;
+static __thread char timestamp_cache[32];
+
+// Marca o buffer para reaproveitamento quando a thread dona termina
+static void liberar_buffer_thread(void *ptr) {
+    BufferLog *buffer = ptr;
+    __atomic_store_n(&buffer->abandonado, 1, __ATOMIC_RELEASE);
+}
+
+// Obtém (ou registra) o buffer da thread atual
+static BufferLog *obter_buffer_thread(void) {
+    if (buffer_thread != NULL) return buffer_thread;
+    
+    pthread_mutex_lock(&log_global.mutex_registro);
+    
+    // Reaproveita o buffer de uma thread que terminou, se já foi esvaziado
+    BufferLog *buffer = log_global.buffers;
+    while (buffer != NULL) {
+        if (__atomic_load_n(&buffer->abandonado, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&buffer->lido, __ATOMIC_ACQUIRE) == buffer->escrito) {
+            buffer->abandonado = 0;
+            break;
+        }
+        buffer = buffer->proximo;
+    }
+    
+    if (buffer == NULL) {
+        buffer = calloc(1, sizeof(BufferLog));
+        if (buffer != NULL) {
+            buffer->pendente = SEM_PENDENTE;
+            buffer->proximo = log_global.buffers;
+            __atomic_store_n(&log_global.buffers, buffer, __ATOMIC_RELEASE);
+        }
+    }
+    
+    pthread_mutex_unlock(&log_global.mutex_registro);
+    
+    if (buffer != NULL) {
+        pthread_setspecific(log_global.chave_thread, buffer);
+        buffer_thread = buffer;
+    }
+    return buffer;
+}
+
+// Escreve todo o bloco, continuando após escritas parciais
+static void escrever_tudo(int fd, const char *dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t escritos = write(fd, dados, tamanho);
+        if (escritos < 0) return;
+        dados += escritos;
+        tamanho -= escritos;
+    }
+}
+
+// Copia n bytes para o anel a partir da posição pos (com volta)
+static void copiar_para_anel(BufferLog *buffer, unsigned long long pos, const void *origem, size_t n) {
+    size_t inicio = pos % LOG_TAMANHO_BUFFER;
+    size_t ate_o_fim = LOG_TAMANHO_BUFFER - inicio;
+    
+    if (n <= ate_o_fim) {
+        memcpy(buffer->dados + inicio, origem, n);
+    } else {
+        memcpy(buffer->dados + inicio, origem, ate_o_fim);
+        memcpy(buffer->dados, (const char *)origem + ate_o_fim, n - ate_o_fim);
+    }
+}
+
+// Copia n bytes do anel a partir da posição pos (com volta)
+static void copiar_do_anel(const BufferLog *buffer, unsigned long long pos, void *destino, size_t n) {
+    size_t inicio = pos % LOG_TAMANHO_BUFFER;
+    size_t ate_o_fim = LOG_TAMANHO_BUFFER - inicio;
+    
+    if (n <= ate_o_fim) {
+        memcpy(destino, buffer->dados + inicio, n);
+    } else {
+        memcpy(destino, buffer->dados + inicio, ate_o_fim);
+        memcpy((char *)destino + ate_o_fim, buffer->dados, n - ate_o_fim);
+    }
+}
+
+// Descarrega os buffers, intercalando as linhas pela ordem global dos eventos.
+// Uma thread pode ter tirado seu número e ainda não ter publicado a linha: só
+// saem as linhas abaixo da menor sequência ainda não publicada, e as demais
+// ficam para a próxima descarga.
+static void descarregar_buffers(void) {
+    static char saida[LOG_TAMANHO_SAIDA];
+    
+    // Lido antes dos buffers: cada linha abaixo dele já foi publicada ou ainda
+    // tem o buffer marcado como pendente (ver log_evento)
+    unsigned long long limite = __atomic_load_n(&log_global.sequencia, __ATOMIC_SEQ_CST);
+    
+    int total_buffers = 0;
+    for (BufferLog *b = __atomic_load_n(&log_global.buffers, __ATOMIC_ACQUIRE); b != NULL; b = b->proximo) {
+        total_buffers++;
+    }
+    if (total_buffers == 0) return;
+    
+    BufferLog **origens = malloc(sizeof(BufferLog *) * total_buffers);
+    unsigned long long *posicoes = malloc(sizeof(unsigned long long) * total_buffers);
+    unsigned long long *fins = malloc(sizeof(unsigned long long) * total_buffers);
+    if (origens == NULL || posicoes == NULL || fins == NULL) {
+        free(origens);
+        free(posicoes);
+        free(fins);
+        return;
+    }
+    
+    // Fotografa o trecho pendente de cada buffer
+    int i = 0;
+    BufferLog *buffer = __atomic_load_n(&log_global.buffers, __ATOMIC_ACQUIRE);
+    for (; buffer != NULL && i < total_buffers; buffer = buffer->proximo, i++) {
+        origens[i] = buffer;
+        posicoes[i] = buffer->lido;
+        unsigned long long pendente = __atomic_load_n(&buffer->pendente, __ATOMIC_SEQ_CST);
+        if (pendente < limite) limite = pendente;
+        fins[i] = __atomic_load_n(&buffer->escrito, __ATOMIC_ACQUIRE);
+    }
+    
+    // Intercala: a cada passo, a linha de menor sequência entre os buffers
+    size_t usado = 0;
+    for (;;) {
+        int escolhido = -1;
+        CabecalhoLinha menor = { 0, 0 };
+        for (i = 0; i < total_buffers; i++) {
+            if (posicoes[i] == fins[i]) continue;
+            CabecalhoLinha cabecalho;
+            copiar_do_anel(origens[i], posicoes[i], &cabecalho, sizeof(cabecalho));
+            if (cabecalho.sequencia >= limite) continue;
+            if (escolhido == -1 || cabecalho.sequencia < menor.sequencia) {
+                escolhido = i;
+                menor = cabecalho;
+            }
+        }
+        if (escolhido == -1) break;
+        
+        if (usado + menor.tamanho > sizeof(saida)) {
+            escrever_tudo(log_global.fd, saida, usado);
+            usado = 0;
+        }
+        copiar_do_anel(origens[escolhido], posicoes[escolhido] + sizeof(CabecalhoLinha),
+                       saida + usado, menor.tamanho);
+        usado += menor.tamanho;
+        posicoes[escolhido] += sizeof(CabecalhoLinha) + menor.tamanho;
+    }
+    
+    if (usado > 0) {
+        escrever_tudo(log_global.fd, saida, usado);
+    }
+    
+    // Devolve o espaço aos donos só depois da escrita, acordando quem espera por ele
+    for (i = 0; i < total_buffers; i++) {
+        if (posicoes[i] == origens[i]->lido) continue;
+        __atomic_store_n(&origens[i]->lido, posicoes[i], __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&origens[i]->esperando, __ATOMIC_SEQ_CST)) {
+            __atomic_add_fetch(&origens[i]->versao_lido, 1, __ATOMIC_SEQ_CST);
+            futex_acordar(&origens[i]->versao_lido, 1);
+        }
+    }
+    
+    free(origens);
+    free(posicoes);
+    free(fins);
+}
+
+// Thread escritora: descarrega a cada intervalo ou quando um buffer enche
+static void *thread_escritor_log(void *arg) {
+    (void)arg;
+    
+    while (!__atomic_load_n(&log_global.encerrando, __ATOMIC_ACQUIRE)) {
+        unsigned int despertar = __atomic_load_n(&log_global.despertar, __ATOMIC_ACQUIRE);
+        descarregar_buffers();
+        futex_esperar(&log_global.despertar, despertar, log_global.intervalo_ms);
+    }
+    
+    // Descarga final garantida
+    descarregar_buffers();
+    return NULL;
+}
+
+// Escrita direta, usada antes de inicializar_log ou depois de finalizar_log
+static void log_evento_sincrono(const char *linha, size_t tamanho) {
+    static pthread_mutex_t mutex_sincrono = PTHREAD_MUTEX_INITIALIZER;
+    
+    pthread_mutex_lock(&mutex_sincrono);
+    
+    int fd = open(ARQUIVO_LOG, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd != -1) {
+        escrever_tudo(fd, linha, tamanho);
+        close(fd);
+    }
+    
+    pthread_mutex_unlock(&mutex_sincrono);
+}
+
+// Abre o arquivo de log e inicia a thread escritora
+int inicializar_log(const char *nome_arquivo, int intervalo_ms) {
+    if (log_global.ativo) return 0;
+    
+    log_global.fd = open(nome_arquivo, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log_global.fd == -1) {
+        perror("Erro ao abrir arquivo de log");
+        return -1;
+    }
+    
+    log_global.intervalo_ms = intervalo_ms > 0 ? intervalo_ms : LOG_INTERVALO_PADRAO_MS;
+    log_global.encerrando = 0;
+    pthread_key_create(&log_global.chave_thread, liberar_buffer_thread);
+    
+    if (pthread_create(&log_global.escritor, NULL, thread_escritor_log, NULL) != 0) {
+        perror("Erro ao criar thread do log");
+        close(log_global.fd);
+        log_global.fd = -1;
+        return -1;
+    }
+    
+    __atomic_store_n(&log_global.ativo, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Descarrega tudo o que foi registrado e fecha o arquivo de log
+void finalizar_log(void) {
+    if (!log_global.ativo) return;
+    
+    __atomic_store_n(&log_global.ativo, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&log_global.encerrando, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&log_global.despertar, 1, __ATOMIC_RELEASE);
+    futex_acordar(&log_global.despertar, 1);
+    pthread_join(log_global.escritor, NULL);
+    
+    close(log_global.fd);
+    log_global.fd = -1;
+    
+    BufferLog *buffer = log_global.buffers;
+    while (buffer != NULL) {
+        BufferLog *proximo = buffer->proximo;
+        free(buffer);
+        buffer = proximo;
+    }
+    log_global.buffers = NULL;
+    buffer_thread = NULL;
+    pthread_key_delete(log_global.chave_thread);
+}
+
+// Registra evento no arquivo de log.
+// Com o log ativo, só formata no buffer da thread, sem chamadas de sistema
+// (salvo com o buffer cheio); a ordem global vem de um contador atômico.
+void log_evento(const char *evento) {
+    char linha[LOG_LINHA_MAX];
+    time_t agora = time(NULL);
+    
+    if (agora != segundo_cache) {
+        struct tm info_tempo;
+        localtime_r(&agora, &info_tempo);
+        strftime(timestamp_cache, sizeof(timestamp_cache), "%Y-%m-%d %H:%M:%S", &info_tempo);
+        segundo_cache = agora;
+    }
+    
+    int tamanho = snprintf(linha, sizeof(linha), "[%s] %s\n", timestamp_cache, evento);
+    if (tamanho < 0) return;
+    if (tamanho >= (int)sizeof(linha)) {
+        tamanho = sizeof(linha) - 1;
+        linha[tamanho - 1] = '\n';
+    }
+    
+    BufferLog *buffer = NULL;
+    if (__atomic_load_n(&log_global.ativo, __ATOMIC_ACQUIRE)) {
+        buffer = obter_buffer_thread();
+    }
+    if (buffer == NULL) {
+        log_evento_sincrono(linha, tamanho);
+        return;
+    }
+    
+    // Buffer cheio: pede descarga e dorme até o escritor devolver espaço.
+    // Marca a espera e confere de novo antes de dormir.
+    size_t necessario = sizeof(CabecalhoLinha) + tamanho;
+    while (buffer->escrito + necessario - __atomic_load_n(&buffer->lido, __ATOMIC_ACQUIRE) > LOG_TAMANHO_BUFFER) {
+        __atomic_store_n(&buffer->esperando, 1, __ATOMIC_SEQ_CST);
+        unsigned int versao = __atomic_load_n(&buffer->versao_lido, __ATOMIC_SEQ_CST);
+        if (buffer->escrito + necessario - __atomic_load_n(&buffer->lido, __ATOMIC_SEQ_CST) > LOG_TAMANHO_BUFFER) {
+            __atomic_add_fetch(&log_global.despertar, 1, __ATOMIC_RELEASE);
+            futex_acordar(&log_global.despertar, 1);
+            futex_esperar(&buffer->versao_lido, versao, -1);
+        }
+        __atomic_store_n(&buffer->esperando, 0, __ATOMIC_RELAXED);
+    }
+    
+    // Marca a linha como pendente antes de tirar o número, com um limite
+    // inferior dele: o escritor não passa dali até a linha ser publicada
+    __atomic_store_n(&buffer->pendente, __atomic_load_n(&log_global.sequencia, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    CabecalhoLinha cabecalho;
+    cabecalho.sequencia = __atomic_fetch_add(&log_global.sequencia, 1, __ATOMIC_SEQ_CST);
+    cabecalho.tamanho = tamanho;
+    copiar_para_anel(buffer, buffer->escrito, &cabecalho, sizeof(cabecalho));
+    copiar_para_anel(buffer, buffer->escrito + sizeof(cabecalho), linha, tamanho);
+    __atomic_store_n(&buffer->escrito, buffer->escrito + necessario, __ATOMIC_RELEASE);
+    __atomic_store_n(&buffer->pendente, SEM_PENDENTE, __ATOMIC_SEQ_CST);
+}
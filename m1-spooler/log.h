@@ -0,0 +1,15 @@
+#ifndef LOG_H
+#define LOG_H
+
+#define ARQUIVO_LOG "log_servidor.txt"
+#define LOG_INTERVALO_PADRAO_MS 100     // Intervalo padrão entre descargas do log
+#define LOG_TAMANHO_BUFFER (64 * 1024)  // Buffer de cada thread (potência de 2)
+#define LOG_LINHA_MAX 512
+#define LOG_TAMANHO_SAIDA (256 * 1024)  // Bloco de escrita da thread escritora
+
+// Protótipos das funções
+int inicializar_log(const char *nome_arquivo, int intervalo_ms);
+void finalizar_log(void);
+void log_evento(const char *evento);
+
+#endif
@@ -0,0 +1,284 @@
+#include "fila.h"
+
+// Uso de uma impressora; cada uma em sua linha de cache
+typedef struct {
+    unsigned long long ocupada_ns;  // Tempo dos trabalhos concluídos
+    long long inicio_atual_ns;      // Início do trabalho em andamento (0 = ociosa)
+    unsigned long long trabalhos;
+} __attribute__((aligned(TAMANHO_LINHA_CACHE))) MetricasImpressora;
+
+// Estado das métricas do servidor
+static struct {
+    long long partida_ns;
+    unsigned long long recebidos __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Pela ingestão
+    unsigned long long recusados;
+    unsigned long long impressos __attribute__((aligned(TAMANHO_LINHA_CACHE))); // Pelas impressoras
+    unsigned long long paginas;
+    unsigned long long interrompidos;   // Impressões abortadas no encerramento
+    Histograma espera;          // Recepção -> início da impressão (µs)
+    Histograma impressao;       // Duração da impressão (µs)
+    Histograma ponta_a_ponta;   // Recepção -> fim da impressão (µs)
+    Histograma profundidade;    // Trabalhos na fila a cada lote recebido
+    MetricasImpressora impressoras[MAX_IMPRESSORAS];
+    const char *arquivo;
+    int intervalo_ms;
+    int ativo;
+    int encerrando;
+    unsigned int despertar;     // Futex: encerra a thread de relatório
+    pthread_t relator;
+} metricas_global;
+
+// Relógio monotônico em nanossegundos
+long long instante_ns(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (long long)agora.tv_sec * 1000000000LL + agora.tv_nsec;
+}
+
+static int indice_histograma(unsigned long long valor) {
+    if (valor < HISTOGRAMA_SUB) return (int)valor;
+    
+    // Os HISTOGRAMA_BITS_SUB bits abaixo do mais alto escolhem o bucket da potência
+    int deslocamento = 63 - __builtin_clzll(valor) - HISTOGRAMA_BITS_SUB;
+    return (deslocamento + 1) * HISTOGRAMA_SUB + (int)(valor >> deslocamento) - HISTOGRAMA_SUB;
+}
+
+// Maior valor que cai no bucket indice
+static unsigned long long limite_bucket(int indice) {
+    if (indice < HISTOGRAMA_SUB) return (unsigned long long)indice;
+    
+    int deslocamento = indice / HISTOGRAMA_SUB - 1;
+    unsigned long long mantissa = (unsigned long long)(indice % HISTOGRAMA_SUB) + HISTOGRAMA_SUB;
+    return ((mantissa + 1) << deslocamento) - 1;
+}
+
+void registrar_valor(Histograma *histograma, unsigned long long valor) {
+    __atomic_fetch_add(&histograma->contagens[indice_histograma(valor)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histograma->soma, valor, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histograma->total, 1, __ATOMIC_RELAXED);
+    
+    unsigned long long maximo = __atomic_load_n(&histograma->maximo, __ATOMIC_RELAXED);
+    while (valor > maximo &&
+           !__atomic_compare_exchange_n(&histograma->maximo, &maximo, valor, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Percentis pelo limite superior do bucket (nunca acima do máximo visto)
+void resumir_histograma(Histograma *histograma, ResumoHistograma *resumo) {
+    static const double fracoes[] = { 0.50, 0.90, 0.99, 0.999 };
+    unsigned long long *percentis[] = { &resumo->p50, &resumo->p90, &resumo->p99, &resumo->p999 };
+    
+    memset(resumo, 0, sizeof(*resumo));
+    resumo->maximo = __atomic_load_n(&histograma->maximo, __ATOMIC_RELAXED);
+    
+    for (int i = 0; i < HISTOGRAMA_BUCKETS; i++) {
+        resumo->total += __atomic_load_n(&histograma->contagens[i], __ATOMIC_RELAXED);
+    }
+    if (resumo->total == 0) return;
+    
+    resumo->media = (double)__atomic_load_n(&histograma->soma, __ATOMIC_RELAXED) /
+                    (double)__atomic_load_n(&histograma->total, __ATOMIC_RELAXED);
+    
+    for (int p = 0; p < 4; p++) *percentis[p] = resumo->maximo;
+    
+    unsigned long long acumulado = 0;
+    int proximo = 0;
+    for (int i = 0; i < HISTOGRAMA_BUCKETS && proximo < 4; i++) {
+        acumulado += __atomic_load_n(&histograma->contagens[i], __ATOMIC_RELAXED);
+        while (proximo < 4 && acumulado >= (unsigned long long)(fracoes[proximo] * resumo->total + 0.5)) {
+            unsigned long long limite = limite_bucket(i);
+            *percentis[proximo++] = limite < resumo->maximo ? limite : resumo->maximo;
+        }
+    }
+}
+
+void escrever_histograma(FILE *saida, const char *nome, Histograma *histograma,
+                                double escala, int casas) {
+    ResumoHistograma r;
+    resumir_histograma(histograma, &r);
+    
+    fprintf(saida, "%s: n=%llu média=%.*f p50=%.*f p90=%.*f p99=%.*f p99.9=%.*f máx=%.*f\n",
+            nome, r.total, casas, r.media / escala, casas, r.p50 / escala, casas, r.p90 / escala,
+            casas, r.p99 / escala, casas, r.p999 / escala, casas, r.maximo / escala);
+}
+
+// Tempo ocupado da impressora até agora, incluindo o trabalho em andamento
+static unsigned long long tempo_ocupado(const MetricasImpressora *impressora, long long agora) {
+    unsigned long long ocupada = __atomic_load_n(&impressora->ocupada_ns, __ATOMIC_RELAXED);
+    long long inicio = __atomic_load_n(&impressora->inicio_atual_ns, __ATOMIC_RELAXED);
+    if (inicio > 0 && agora > inicio) ocupada += (unsigned long long)(agora - inicio);
+    return ocupada;
+}
+
+// Escreve contadores, histogramas e utilização. Com ocupada_anterior, mostra
+// também a utilização desde o retrato anterior (e atualiza o vetor).
+static void escrever_relatorio(FILE *saida, long long agora, unsigned long long *ocupada_anterior,
+                               long long intervalo_ns) {
+    double decorrido = (agora - metricas_global.partida_ns) / 1e9;
+    unsigned long long impressos = __atomic_load_n(&metricas_global.impressos, __ATOMIC_RELAXED);
+    unsigned long long paginas = __atomic_load_n(&metricas_global.paginas, __ATOMIC_RELAXED);
+    
+    fprintf(saida, "Tempo de operação: %.3f s\n", decorrido);
+    fprintf(saida, "Trabalhos: %llu recebidos, %llu recusados, %llu impressos (%llu páginas), %llu interrompidos\n",
+            __atomic_load_n(&metricas_global.recebidos, __ATOMIC_RELAXED),
+            __atomic_load_n(&metricas_global.recusados, __ATOMIC_RELAXED), impressos, paginas,
+            __atomic_load_n(&metricas_global.interrompidos, __ATOMIC_RELAXED));
+    if (decorrido > 0) {
+        fprintf(saida, "Vazão: %.2f trabalhos/s, %.2f páginas/s\n", impressos / decorrido, paginas / decorrido);
+    }
+    
+    escrever_histograma(saida, "Espera na fila (ms)", &metricas_global.espera, 1000.0, 3);
+    escrever_histograma(saida, "Impressão (ms)", &metricas_global.impressao, 1000.0, 3);
+    escrever_histograma(saida, "Ponta a ponta (ms)", &metricas_global.ponta_a_ponta, 1000.0, 3);
+    escrever_histograma(saida, "Profundidade da fila", &metricas_global.profundidade, 1.0, 1);
+    
+    for (int i = 0; i < MAX_IMPRESSORAS; i++) {
+        MetricasImpressora *impressora = &metricas_global.impressoras[i];
+        unsigned long long ocupada = tempo_ocupado(impressora, agora);
+        if (ocupada == 0) continue;
+        
+        fprintf(saida, "Impressora %d: %llu trabalhos, utilização %.1f%%", i + 1,
+                __atomic_load_n(&impressora->trabalhos, __ATOMIC_RELAXED),
+                decorrido > 0 ? 100.0 * ocupada / (decorrido * 1e9) : 0.0);
+        if (ocupada_anterior != NULL && intervalo_ns > 0) {
+            fprintf(saida, " (%.1f%% no último intervalo)",
+                    100.0 * (ocupada - ocupada_anterior[i]) / intervalo_ns);
+            ocupada_anterior[i] = ocupada;
+        }
+        fprintf(saida, "\n");
+    }
+}
+
+// Grava um retrato no arquivo de métricas; a troca por rename() faz um
+// leitor ver sempre um retrato inteiro
+static void gravar_retrato(unsigned long long *ocupada_anterior, long long *instante_anterior) {
+    char temporario[256];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", metricas_global.arquivo);
+    
+    FILE *arquivo = fopen(temporario, "w");
+    if (arquivo == NULL) return;
+    
+    long long agora = relogio_impressao_ns();
+    escrever_relatorio(arquivo, agora, ocupada_anterior, agora - *instante_anterior);
+    *instante_anterior = agora;
+    
+    if (fclose(arquivo) == 0) {
+        rename(temporario, metricas_global.arquivo);
+    } else {
+        unlink(temporario);
+    }
+}
+
+// Thread de relatório: grava um retrato a cada intervalo e um último ao encerrar
+static void *thread_relatorio_metricas(void *arg) {
+    (void)arg;
+    unsigned long long ocupada_anterior[MAX_IMPRESSORAS] = { 0 };
+    long long instante_anterior = metricas_global.partida_ns;
+    
+    while (!__atomic_load_n(&metricas_global.encerrando, __ATOMIC_ACQUIRE)) {
+        unsigned int despertar = __atomic_load_n(&metricas_global.despertar, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&metricas_global.encerrando, __ATOMIC_ACQUIRE)) break;
+        futex_esperar(&metricas_global.despertar, despertar, metricas_global.intervalo_ms);
+        gravar_retrato(ocupada_anterior, &instante_anterior);
+    }
+    
+    return NULL;
+}
+
+// Marca o início da medição e, com nome_arquivo e intervalo_ms > 0, inicia a
+// thread que grava os retratos periódicos
+int inicializar_metricas(const char *nome_arquivo, int intervalo_ms) {
+    metricas_global.partida_ns = relogio_impressao_ns();
+    if (nome_arquivo == NULL || intervalo_ms <= 0) return 0;
+    
+    metricas_global.arquivo = nome_arquivo;
+    metricas_global.intervalo_ms = intervalo_ms;
+    metricas_global.encerrando = 0;
+    
+    if (pthread_create(&metricas_global.relator, NULL, thread_relatorio_metricas, NULL) != 0) {
+        perror("Erro ao criar thread de métricas");
+        return -1;
+    }
+    metricas_global.ativo = 1;
+    return 0;
+}
+
+// Para a thread de relatório (que grava o retrato final) e escreve o resumo em saida
+void finalizar_metricas(FILE *saida) {
+    if (metricas_global.ativo) {
+        __atomic_store_n(&metricas_global.encerrando, 1, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&metricas_global.despertar, 1, __ATOMIC_RELEASE);
+        futex_acordar(&metricas_global.despertar, 1);
+        pthread_join(metricas_global.relator, NULL);
+        metricas_global.ativo = 0;
+    }
+    
+    if (saida != NULL) {
+        fprintf(saida, "=== Métricas do servidor ===\n");
+        escrever_relatorio(saida, relogio_impressao_ns(), NULL, 0);
+    }
+}
+
+// Chamado pela ingestão depois de enfileirar um lote; profundidade é o
+// tamanho da fila logo após a inserção
+void metricas_lote_recebido(int quantidade, int enfileirados, int profundidade) {
+    __atomic_fetch_add(&metricas_global.recebidos, (unsigned long long)quantidade, __ATOMIC_RELAXED);
+    if (enfileirados < quantidade) {
+        __atomic_fetch_add(&metricas_global.recusados, (unsigned long long)(quantidade - enfileirados),
+                           __ATOMIC_RELAXED);
+    }
+    registrar_valor(&metricas_global.profundidade, profundidade > 0 ? (unsigned long long)profundidade : 0);
+}
+
+// Chamado pela impressora ao retirar um trabalho: registra a espera na fila
+void metricas_inicio_impressao(int id_impressora, long long recebido_ns, long long inicio_ns) {
+    if (id_impressora < 1 || id_impressora > MAX_IMPRESSORAS) return;
+    
+    __atomic_store_n(&metricas_global.impressoras[id_impressora - 1].inicio_atual_ns, inicio_ns,
+                     __ATOMIC_RELAXED);
+    if (inicio_ns >= recebido_ns) {
+        registrar_valor(&metricas_global.espera, (unsigned long long)(inicio_ns - recebido_ns) / 1000);
+    }
+}
+
+// Chamado pela impressora ao terminar: duração, latência ponta a ponta e uso
+void metricas_fim_impressao(int id_impressora, int paginas, long long recebido_ns,
+                            long long inicio_ns, long long fim_ns) {
+    if (id_impressora < 1 || id_impressora > MAX_IMPRESSORAS) return;
+    MetricasImpressora *impressora = &metricas_global.impressoras[id_impressora - 1];
+    unsigned long long duracao = fim_ns > inicio_ns ? (unsigned long long)(fim_ns - inicio_ns) : 0;
+    
+    __atomic_fetch_add(&impressora->ocupada_ns, duracao, __ATOMIC_RELAXED);
+    __atomic_store_n(&impressora->inicio_atual_ns, 0, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&impressora->trabalhos, 1, __ATOMIC_RELAXED);
+    
+    registrar_valor(&metricas_global.impressao, duracao / 1000);
+    if (fim_ns >= recebido_ns) {
+        registrar_valor(&metricas_global.ponta_a_ponta, (unsigned long long)(fim_ns - recebido_ns) / 1000);
+    }
+    
+    __atomic_fetch_add(&metricas_global.paginas, (unsigned long long)(paginas > 0 ? paginas : 0),
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&metricas_global.impressos, 1, __ATOMIC_RELAXED);
+}
+
+// Chamado pela impressora quando o encerramento aborta a impressão: conta o
+// tempo ocupado, mas não o trabalho
+void metricas_impressao_interrompida(int id_impressora, long long inicio_ns, long long fim_ns) {
+    if (id_impressora < 1 || id_impressora > MAX_IMPRESSORAS) return;
+    MetricasImpressora *impressora = &metricas_global.impressoras[id_impressora - 1];
+    
+    __atomic_fetch_add(&impressora->ocupada_ns, fim_ns > inicio_ns ? (unsigned long long)(fim_ns - inicio_ns) : 0,
+                       __ATOMIC_RELAXED);
+    __atomic_store_n(&impressora->inicio_atual_ns, 0, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&metricas_global.interrompidos, 1, __ATOMIC_RELAXED);
+}
+
+unsigned long long metricas_trabalhos_impressos(void) {
+    return __atomic_load_n(&metricas_global.impressos, __ATOMIC_RELAXED);
+}
+
+unsigned long long metricas_trabalhos_recebidos(void) {
+    return __atomic_load_n(&metricas_global.recebidos, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,49 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdio.h>
+
+#define ARQUIVO_METRICAS "metricas_servidor.txt"
+#define METRICAS_INTERVALO_PADRAO_MS 1000   // Intervalo padrão entre retratos no arquivo
+
+// Histograma log-linear (estilo HDR): valores abaixo de HISTOGRAMA_SUB têm
+// bucket próprio; acima, cada potência de 2 é dividida em HISTOGRAMA_SUB
+// buckets, o que dá erro relativo máximo de 1/HISTOGRAMA_SUB (~1,6%) em
+// toda a faixa de 64 bits com tamanho fixo
+#define HISTOGRAMA_BITS_SUB 6
+#define HISTOGRAMA_SUB (1 << HISTOGRAMA_BITS_SUB)
+#define HISTOGRAMA_BUCKETS ((65 - HISTOGRAMA_BITS_SUB) * HISTOGRAMA_SUB)
+
+// Contadores atualizados sem lock (incrementos atômicos relaxados); a
+// leitura do relatório é aproximada enquanto há threads gravando. Só tem
+// atômicos, então também serve em memória compartilhada entre processos.
+typedef struct {
+    unsigned long long total;
+    unsigned long long soma;
+    unsigned long long maximo;
+    unsigned long long contagens[HISTOGRAMA_BUCKETS];
+} Histograma;
+
+// Percentis de um histograma, na unidade em que os valores foram gravados
+typedef struct {
+    unsigned long long total;
+    double media;
+    unsigned long long p50, p90, p99, p999, maximo;
+} ResumoHistograma;
+
+// Protótipos das funções
+long long instante_ns(void);
+void registrar_valor(Histograma *histograma, unsigned long long valor);
+void resumir_histograma(Histograma *histograma, ResumoHistograma *resumo);
+void escrever_histograma(FILE *saida, const char *nome, Histograma *histograma, double escala, int casas);
+int inicializar_metricas(const char *nome_arquivo, int intervalo_ms);
+void finalizar_metricas(FILE *saida);
+void metricas_lote_recebido(int quantidade, int enfileirados, int profundidade);
+void metricas_inicio_impressao(int id_impressora, long long recebido_ns, long long inicio_ns);
+void metricas_fim_impressao(int id_impressora, int paginas, long long recebido_ns,
+                            long long inicio_ns, long long fim_ns);
+void metricas_impressao_interrompida(int id_impressora, long long inicio_ns, long long fim_ns);
+unsigned long long metricas_trabalhos_impressos(void);
+unsigned long long metricas_trabalhos_recebidos(void);
+
+#endif
@@ -1,56 +1,394 @@
+#define _GNU_SOURCE     // accept4
 #include "fila.h"
+#include "diario.h"
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <errno.h>
+#include <stdint.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 // Variáveis globais
-FilaImpressao fila_global;
+FilasImpressoras filas_global;          // Política FIFO: uma fila por impressora
+FilaPrioridade fila_prioridade_global;  // Políticas de prioridade e SJF
+PoliticaFila politica_global = POLITICA_FIFO;
+MemoriaCompartilhada *memoria_global = NULL;
 pthread_t threads_impressoras[MAX_IMPRESSORAS];
+int ids_impressoras[MAX_IMPRESSORAS];
+int threads_criadas[MAX_IMPRESSORAS];  // Slot já teve uma thread (a juntar antes de reusar)
+int num_impressoras = IMPRESSORAS_PADRAO;
+int impressoras_ativas = 0;
+int min_impressoras = 0;    // Limites da autoescala; 0 = desligada
+int max_impressoras = 0;
+pthread_t thread_shm;
+pthread_t thread_autoescala;
+unsigned int despertador_autoescala = 0;   // Futex: acorda a autoescala na finalização
 int servidor_ativo = 1;
-int pipe_fd;
+int proximo_id_job = 1;     // IDs atribuídos pelo servidor a todos os trabalhos
+TrabalhoImpressao *trabalhos_recuperados = NULL;    // Pendentes do diário, recolocados na fila
+int num_recuperados = 0;
+pthread_t thread_recuperacao;
+
+// Encerramento: com drenar, as impressoras esvaziam a fila antes de sair; com
+// abortar, interrompem a impressão atual (o trabalho fica pendente no diário).
+// Um segundo sinal durante a drenagem passa a abortar.
+typedef enum { ENCERRAMENTO_DRENAR, ENCERRAMENTO_ABORTAR } ModoEncerramento;
+
+ModoEncerramento modo_encerramento = ENCERRAMENTO_DRENAR;
+int sinal_fd = -1;              // signalfd de SIGINT/SIGTERM (bloqueados em todas as threads)
+int evento_impressoras = -1;    // eventfd: cada impressora que sai soma 1
+int espaco_fila_fd = -1;        // eventfd: uma impressora abriu espaço para os lotes adiados
+int ingestao_esperando_espaco = 0;  // A ingestão tem lotes adiados por fila cheia
+int impressoras_em_execucao = 0;
+int sinal_recebido = 0;
+long long inicio_encerramento_ns = 0;
+
+// Origem de dados no epoll da ingestão: o socket de escuta, o pipe, um cliente
+// ou o eventfd com que as impressoras avisam que abriram espaço na fila
+typedef enum { FONTE_ESCUTA, FONTE_PIPE, FONTE_CLIENTE, FONTE_ESPACO } TipoFonte;
+
+typedef struct FonteIngestao {
+    TipoFonte tipo;
+    int fd;
+    char resto[sizeof(TrabalhoImpressao)];  // Registro partido entre leituras
+    size_t tamanho_resto;
+    ConfirmacaoTrabalho *confirmacoes;      // Confirmações ainda não enviadas (clientes)
+    size_t total_confirmacoes;
+    size_t bytes_enviados;                  // Parte de confirmacoes já enviada
+    size_t confirmacoes_decididas;          // Já cobertas por um group commit (status definitivo)
+    size_t capacidade_confirmacoes;
+    TrabalhoImpressao *adiados;             // Já registrados, à espera de espaço na fila
+    int num_adiados;
+    size_t lote_adiado;                     // Primeira confirmação do lote que tem adiados
+    int lendo;                              // EPOLLIN ativo (desligado com adiados ou se o cliente não lê as confirmações)
+    uint32_t eventos;                       // Registrados no epoll
+    int na_rodada;                          // Já está na lista do group commit desta rodada
+    struct FonteIngestao *proxima_rodada;
+    struct FonteIngestao *proxima_espera;   // Fila das fontes com adiados
+    struct FonteIngestao *anterior;         // Lista de fontes abertas (fechadas no encerramento)
+    struct FonteIngestao *proxima;
+} FonteIngestao;
+
+FonteIngestao *fontes_abertas = NULL;
+FonteIngestao fonte_espaco = { .tipo = FONTE_ESPACO, .fd = -1 };
+FonteIngestao *espera_inicio = NULL;    // Fontes com lotes adiados, à espera de espaço na fila
+FonteIngestao *espera_fim = NULL;
+
+// Coloca trabalhos na fila das impressoras conforme a política; retorna quantos entraram
+int colocar_na_fila(const TrabalhoImpressao *trabalhos, int quantidade) {
+    if (politica_global == POLITICA_FIFO) {
+        return distribuir_lote(&filas_global, trabalhos, quantidade);
+    }
+    return enfileirar_lote_prioridade(&fila_prioridade_global, trabalhos, quantidade);
+}
+
+// Retira o próximo trabalho da impressora indice conforme a política; bloqueia com
+// a fila vazia. Retorna 0, 1 se o trabalho foi roubado de outra impressora, ou -1.
+int retirar_da_fila(int indice, TrabalhoImpressao *trabalho) {
+    if (politica_global == POLITICA_FIFO) {
+        return retirar_trabalho_local(&filas_global, indice, trabalho);
+    }
+    return desenfileirar_prioridade(&fila_prioridade_global, indice, trabalho);
+}
+
+// Versão sem bloqueio de colocar_na_fila: insere o que couber agora e deixa os
+// que entraram no início de trabalhos, na ordem de chegada. Retorna quantos entraram.
+int tentar_colocar_na_fila(TrabalhoImpressao *trabalhos, int quantidade) {
+    if (politica_global == POLITICA_FIFO) {
+        return tentar_distribuir_lote(&filas_global, trabalhos, quantidade);
+    }
+    return tentar_enfileirar_lote_prioridade(&fila_prioridade_global, trabalhos, quantidade);
+}
+
+// Chamado pela impressora depois de retirar um trabalho: se a ingestão tem
+// lotes adiados por fila cheia, avisa pelo eventfd (uma vez por espera)
+void avisar_espaco_liberado(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ingestao_esperando_espaco, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n(&ingestao_esperando_espaco, 0, __ATOMIC_SEQ_CST)) {
+        uint64_t um = 1;
+        if (write(espaco_fila_fd, &um, sizeof(um)) == -1) {
+            perror("Erro ao avisar espaço na fila");
+        }
+    }
+}
+
+// Versão sem bloqueio de retirar_da_fila: -1 se não há trabalho agora
+int tentar_retirar_da_fila(int indice, TrabalhoImpressao *trabalho) {
+    if (politica_global == POLITICA_FIFO) {
+        return tentar_retirar_trabalho_local(&filas_global, indice, trabalho);
+    }
+    return tentar_retirar_prioridade(&fila_prioridade_global, indice, trabalho);
+}
+
+// Trabalhos e páginas à espera na fila da política atual
+void medir_fila(int *trabalhos, long long *paginas) {
+    if (politica_global == POLITICA_FIFO) {
+        medir_filas_impressoras(&filas_global, trabalhos, paginas);
+    } else {
+        medir_fila_prioridade(&fila_prioridade_global, trabalhos, paginas);
+    }
+}
 
 // Função executada por cada thread impressora
 void* thread_impressora(void* arg) {
     int id_impressora = *(int*)arg;
     TrabalhoImpressao trabalho;
     char evento[256];
+    int impressos = 0;
+    int roubados = 0;
     
     snprintf(evento, sizeof(evento), "Impressora %d iniciada", id_impressora);
     log_evento(evento);
+    impressora_iniciada(id_impressora - 1);
     
-    while (servidor_ativo) {
-        // Tenta desenfileirar um trabalho (bloqueia se não houver trabalhos)
-        if (desenfileirar_trabalho(&fila_global, &trabalho) == 0) {
-            // Processa o trabalho
-            imprimir_trabalho(trabalho, id_impressora);
-        } else {
-            // Se houve erro, provavelmente o servidor está sendo finalizado
-            if (!servidor_ativo) break;
+    while (!impressoes_abortadas()) {
+        // Tenta desenfileirar um trabalho; sem nenhum à vista, avisa o backend
+        // (o relógio virtual não espera por ela) e bloqueia na fila
+        int origem = tentar_retirar_da_fila(id_impressora - 1, &trabalho);
+        if (origem < 0) {
+            impressora_ociosa(id_impressora - 1);
+            origem = retirar_da_fila(id_impressora - 1, &trabalho);
+        }
+        if (origem < 0) {
+            // Fila encerrada e vazia ou impressora retirada pela autoescala
+            break;
+        }
+        avisar_espaco_liberado();
+        
+        // Processa o trabalho; abortado, ele continua pendente no diário
+        if (imprimir_trabalho(trabalho, id_impressora) != 0) {
+            break;
         }
+        diario_registrar_concluido(trabalho.id_job);
+        impressos++;
+        roubados += origem;
     }
     
-    snprintf(evento, sizeof(evento), "Impressora %d finalizada", id_impressora);
+    if (politica_global == POLITICA_FIFO) {
+        snprintf(evento, sizeof(evento), "Impressora %d finalizada - %d trabalhos, %d roubados de outras filas",
+                 id_impressora, impressos, roubados);
+    } else {
+        snprintf(evento, sizeof(evento), "Impressora %d finalizada - %d trabalhos", id_impressora, impressos);
+    }
     log_evento(evento);
+    impressora_finalizada(id_impressora - 1);
+    
+    // Avisa o encerramento, que espera as impressoras pelo eventfd
+    __atomic_sub_fetch(&impressoras_em_execucao, 1, __ATOMIC_SEQ_CST);
+    uint64_t um = 1;
+    if (write(evento_impressoras, &um, sizeof(um)) == -1) {
+        perror("Erro ao avisar saída da impressora");
+    }
+    
+    return NULL;
+}
+
+// Registra um lote de trabalhos recebidos antes de ele ir para a fila: atribui
+// os IDs do servidor, anota no log e grava no diário. Se confirmacoes não é NULL,
+// preenche uma confirmação por trabalho (aceito até a fila recusá-lo), que só
+// deve ser enviada depois de o diário gravar o lote (diario_aguardar). O console
+// só mostra cada trabalho quando chegam um a um.
+void registrar_lote(TrabalhoImpressao *trabalhos, int quantidade, ConfirmacaoTrabalho *confirmacoes) {
+    char evento[256];
+    int primeiro_id = __atomic_fetch_add(&proximo_id_job, quantidade, __ATOMIC_RELAXED);
+    long long recebido_ns = relogio_impressao_ns();
+    
+    for (int i = 0; i < quantidade; i++) {
+        if (confirmacoes != NULL) {
+            confirmacoes[i].id_cliente = trabalhos[i].id_job;
+            confirmacoes[i].id_job = primeiro_id + i;
+            confirmacoes[i].status = 0;
+        }
+        trabalhos[i].id_job = primeiro_id + i;
+        trabalhos[i].recebido_ns = recebido_ns;
+        
+        snprintf(evento, sizeof(evento), 
+                 "Trabalho recebido - ID: %d, Arquivo: %s, Páginas: %d",
+                 trabalhos[i].id_job, trabalhos[i].nome_arquivo, trabalhos[i].numero_paginas);
+        log_evento(evento);
+    }
+    
+    if (quantidade == 1) {
+        printf("Trabalho recebido: ID %d, Arquivo: %s, Páginas: %d\n",
+               trabalhos[0].id_job, trabalhos[0].nome_arquivo, trabalhos[0].numero_paginas);
+    } else {
+        printf("Lote recebido: %d trabalhos\n", quantidade);
+    }
+    
+    // As impressoras não esperam o disco
+    diario_registrar_enfileirados(trabalhos, quantidade);
+}
+
+// Conta nas métricas e no log o destino de trabalhos já registrados: os
+// enfileirados primeiros entraram na fila, os demais foram recusados
+void contabilizar_lote(const TrabalhoImpressao *trabalhos, int quantidade, int enfileirados) {
+    char evento[128];
+    int profundidade;
+    long long paginas;
+    medir_fila(&profundidade, &paginas);
+    metricas_lote_recebido(quantidade, enfileirados, profundidade);
+    
+    for (int i = 0; i < quantidade; i++) {
+        if (i < enfileirados) {
+            snprintf(evento, sizeof(evento), "Trabalho %d enfileirado com sucesso", trabalhos[i].id_job);
+        } else {
+            snprintf(evento, sizeof(evento), "Erro ao enfileirar trabalho %d", trabalhos[i].id_job);
+        }
+        log_evento(evento);
+    }
+}
+
+// Registra um lote e o coloca na fila de uma vez, bloqueando enquanto ela
+// estiver cheia (threads de ingestão próprias). Retorna quantos entraram.
+int receber_lote(TrabalhoImpressao *trabalhos, int quantidade, ConfirmacaoTrabalho *confirmacoes) {
+    registrar_lote(trabalhos, quantidade, confirmacoes);
+    int enfileirados = colocar_na_fila(trabalhos, quantidade);
+    contabilizar_lote(trabalhos, quantidade, enfileirados);
+    
+    if (confirmacoes != NULL) {
+        for (int i = enfileirados; i < quantidade; i++) {
+            confirmacoes[i].status = -1;
+        }
+    }
+    return enfileirados;
+}
+
+// Thread de ingestão do canal de memória compartilhada
+void* thread_ingestao_shm(void* arg) {
+    (void)arg;
+    TrabalhoImpressao lote[LOTE_INGESTAO];
+    int quantidade;
+    
+    // Bloqueia no futex do anel compartilhado até um cliente enfileirar,
+    // depois leva tudo o que já estiver disponível
+    while ((quantidade = desenfileirar_lote(fila_compartilhada(memoria_global), lote, LOTE_INGESTAO)) > 0) {
+        receber_lote(lote, quantidade, NULL);
+    }
     
     return NULL;
 }
 
-// Handler para sinais de interrupção
-void handler_sinal(int sinal) {
+// Recoloca na fila os trabalhos que o diário trouxe da execução anterior.
+// Roda em thread própria porque bloqueia enquanto as filas estão cheias.
+void* thread_recuperar_diario(void* arg) {
+    (void)arg;
     char evento[128];
-    snprintf(evento, sizeof(evento), "Servidor recebeu sinal %d - iniciando finalização", sinal);
+    int recolocados = 0;
+    
+    while (recolocados < num_recuperados && servidor_ativo) {
+        int parte = num_recuperados - recolocados;
+        if (parte > LOTE_INGESTAO) parte = LOTE_INGESTAO;
+        
+        TrabalhoImpressao *lote = trabalhos_recuperados + recolocados;
+        long long recebido_ns = relogio_impressao_ns();
+        for (int i = 0; i < parte; i++) {
+            lote[i].recebido_ns = recebido_ns;
+        }
+        
+        // Já estão no diário: vão direto para a fila
+        int enfileirados = colocar_na_fila(lote, parte);
+        int profundidade;
+        long long paginas;
+        medir_fila(&profundidade, &paginas);
+        metricas_lote_recebido(parte, enfileirados, profundidade);
+        
+        recolocados += enfileirados;
+        if (enfileirados < parte) break;
+    }
+    
+    snprintf(evento, sizeof(evento), "Diário: %d de %d trabalhos pendentes recolocados na fila",
+             recolocados, num_recuperados);
     log_evento(evento);
+    printf("%s\n", evento);
+    
+    free(trabalhos_recuperados);
+    trabalhos_recuperados = NULL;
+    return NULL;
+}
+
+// Recusa novas inserções nas filas das impressoras e acorda as ociosas, que
+// saem quando a fila esvaziar
+void encerrar_filas_servidor(void) {
+    encerrar_filas_impressoras(&filas_global);
+    encerrar_fila_prioridade(&fila_prioridade_global);
+}
+
+// Primeira fase do encerramento, fora de contexto de sinal (o sinal chega
+// pelo signalfd): para de aceitar trabalhos; abortando, encerra já as filas e
+// as impressoras saem na hora, e drenando elas imprimem o que restou
+void iniciar_encerramento(int sinal) {
+    char evento[160];
     
+    inicio_encerramento_ns = instante_ns();
+    sinal_recebido = sinal;
     servidor_ativo = 0;
     
-    // Fecha o pipe
-    if (pipe_fd != -1) {
-        close(pipe_fd);
+    snprintf(evento, sizeof(evento), "Servidor recebeu sinal %d - encerramento (%s)", sinal,
+             modo_encerramento == ENCERRAMENTO_DRENAR ? "drenar a fila" : "abortar impressões");
+    log_evento(evento);
+    printf("%s\n", evento);
+    
+    // Abortar fecha já as filas das impressoras; na drenagem elas só fecham em
+    // finalizar_servidor, depois que a ingestão entregou os últimos lotes
+    if (modo_encerramento == ENCERRAMENTO_ABORTAR) {
+        abortar_impressoes();
+        encerrar_filas_servidor();
     }
     
-    // Libera semáforos para que as threads possam sair
-    for (int i = 0; i < MAX_IMPRESSORAS; i++) {
-        sem_post(&fila_global.vazio);
+    // Recusa novas submissões por memória compartilhada e acorda a thread de ingestão
+    if (memoria_global != NULL) {
+        __atomic_store_n(&memoria_global->servidor_ativo, 0, __ATOMIC_RELEASE);
+        encerrar_fila(fila_compartilhada(memoria_global));
+    }
+    
+    // Acorda a autoescala
+    __atomic_add_fetch(&despertador_autoescala, 1, __ATOMIC_SEQ_CST);
+    futex_acordar(&despertador_autoescala, 1);
+}
+
+// Lê um sinal pendente no signalfd; retorna o número dele ou 0
+int ler_sinal(void) {
+    struct signalfd_siginfo info;
+    if (read(sinal_fd, &info, sizeof(info)) != sizeof(info)) return 0;
+    return (int)info.ssi_signo;
+}
+
+// Espera todas as impressoras saírem (eventfd). Um sinal durante a drenagem
+// passa a abortar as impressões.
+void aguardar_impressoras(void) {
+    struct pollfd fds[2] = { { .fd = sinal_fd, .events = POLLIN }, { .fd = evento_impressoras, .events = POLLIN } };
+    
+    while (__atomic_load_n(&impressoras_em_execucao, __ATOMIC_SEQ_CST) > 0) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) continue;
+            perror("Erro ao aguardar impressoras");
+            return;
+        }
+        
+        if (fds[0].revents & POLLIN) {
+            int sinal = ler_sinal();
+            if (sinal != 0 && modo_encerramento == ENCERRAMENTO_DRENAR) {
+                char evento[128];
+                modo_encerramento = ENCERRAMENTO_ABORTAR;
+                abortar_impressoes();
+                snprintf(evento, sizeof(evento), "Servidor recebeu sinal %d - drenagem abortada", sinal);
+                log_evento(evento);
+                printf("%s\n", evento);
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t saidas;
+            if (read(evento_impressoras, &saidas, sizeof(saidas)) == -1 && errno != EAGAIN) {
+                perror("Erro ao ler saída das impressoras");
+                return;
+            }
+        }
     }
 }
 
@@ -68,140 +406,883 @@ int criar_pipe() {
     return 0;
 }
 
-void inicializar_servidor() {
-    char evento[128];
+// Cria o socket Unix em que os clientes se conectam
+int criar_socket() {
+    unlink(NOME_SOCKET);
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("Erro ao criar socket");
+        return -1;
+    }
     
-    // Inicializa a fila
-    inicializar_fila(&fila_global);
-    log_evento("Fila de impressão inicializada");
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strncpy(endereco.sun_path, NOME_SOCKET, sizeof(endereco.sun_path) - 1);
     
-    // Configura handlers de sinais
-    signal(SIGINT, handler_sinal);
-    signal(SIGTERM, handler_sinal);
+    if (bind(fd, (struct sockaddr *)&endereco, sizeof(endereco)) == -1 ||
+        listen(fd, SOMAXCONN) == -1) {
+        perror("Erro ao abrir socket para conexões");
+        close(fd);
+        return -1;
+    }
     
-    // Cria as threads impressoras
-    for (int i = 0; i < MAX_IMPRESSORAS; i++) {
-        int* id_impressora = malloc(sizeof(int));
-        *id_impressora = i + 1;
+    printf("Socket criado: %s\n", NOME_SOCKET);
+    return fd;
+}
+
+// Cria a thread da impressora indice, juntando antes a que ocupou o slot
+// (retirada pela autoescala, já saindo ou saída)
+int iniciar_impressora(int indice) {
+    if (threads_criadas[indice]) {
+        pthread_join(threads_impressoras[indice], NULL);
+        threads_criadas[indice] = 0;
+    }
+    
+    ids_impressoras[indice] = indice + 1;
+    __atomic_add_fetch(&impressoras_em_execucao, 1, __ATOMIC_SEQ_CST);
+    if (pthread_create(&threads_impressoras[indice], NULL, thread_impressora, &ids_impressoras[indice]) != 0) {
+        __atomic_sub_fetch(&impressoras_em_execucao, 1, __ATOMIC_SEQ_CST);
+        perror("Erro ao criar thread impressora");
+        return -1;
+    }
+    threads_criadas[indice] = 1;
+    return 0;
+}
+
+// Ajusta o pool para quantidade impressoras: as novas são criadas, e as
+// excedentes terminam o trabalho atual e saem
+void definir_impressoras_ativas(int quantidade) {
+    int anteriores = impressoras_ativas;
+    
+    // Primeiro as threads novas, depois a fila passa a atendê-las
+    for (int i = anteriores; i < quantidade; i++) {
+        if (iniciar_impressora(i) != 0) {
+            quantidade = i;
+            break;
+        }
+    }
+    
+    impressoras_ativas = quantidade;
+    if (politica_global == POLITICA_FIFO) {
+        definir_ativas_filas_impressoras(&filas_global, quantidade);
+    } else {
+        definir_ativas_fila_prioridade(&fila_prioridade_global, quantidade);
+    }
+}
+
+// Autoescala: a cada AUTOESCALA_INTERVALO_MS, estima a espera de um trabalho que
+// chega agora (páginas pendentes / impressoras, ao tempo real por página do modo
+// de tempo; no virtual a espera é nula e a autoescala só retira). Acima de
+// AUTOESCALA_ESPERA_MAX_MS, cresce até a estimativa caber no limite; com a fila
+// vazia por AUTOESCALA_PERIODOS_OCIOSOS períodos seguidos, retira uma impressora.
+void* thread_autoescala_impressoras(void* arg) {
+    (void)arg;
+    char evento[160];
+    int periodos_ociosos = 0;
+    
+    while (servidor_ativo) {
+        unsigned int versao = __atomic_load_n(&despertador_autoescala, __ATOMIC_ACQUIRE);
+        if (!servidor_ativo) break;
+        futex_esperar(&despertador_autoescala, versao, AUTOESCALA_INTERVALO_MS);
+        if (!servidor_ativo) break;
+        
+        int trabalhos;
+        long long paginas;
+        medir_fila(&trabalhos, &paginas);
         
-        if (pthread_create(&threads_impressoras[i], NULL, thread_impressora, id_impressora) != 0) {
-            perror("Erro ao criar thread impressora");
+        int ativas = impressoras_ativas;
+        long long trabalho_ms = paginas * ns_por_pagina_impressao() / 1000000;
+        long long espera_ms = trabalho_ms / ativas;
+        int alvo = ativas;
+        
+        if (espera_ms > AUTOESCALA_ESPERA_MAX_MS) {
+            long long necessarias = (trabalho_ms + AUTOESCALA_ESPERA_MAX_MS - 1) / AUTOESCALA_ESPERA_MAX_MS;
+            alvo = necessarias > max_impressoras ? max_impressoras : (int)necessarias;
+            periodos_ociosos = 0;
+        } else if (trabalhos == 0 && ativas > min_impressoras) {
+            if (++periodos_ociosos >= AUTOESCALA_PERIODOS_OCIOSOS) {
+                alvo = ativas - 1;
+                periodos_ociosos = 0;
+            }
+        } else {
+            periodos_ociosos = 0;
+        }
+        
+        if (alvo != ativas) {
+            definir_impressoras_ativas(alvo);
+            snprintf(evento, sizeof(evento),
+                     "Autoescala: %d -> %d impressoras (%d trabalhos, %lld páginas, espera estimada %lld ms)",
+                     ativas, impressoras_ativas, trabalhos, paginas, espera_ms);
+            log_evento(evento);
+            printf("%s\n", evento);
+        }
+    }
+    
+    return NULL;
+}
+
+void inicializar_servidor(int envelhecimento_ms, DistribuicaoFila distribuicao, int capacidade,
+                          const char *arquivo_diario) {
+    char evento[160];
+    
+    // Filas para o maior pool possível; só as primeiras impressoras ficam ativas
+    int tamanho_pool = max_impressoras > 0 ? max_impressoras : num_impressoras;
+    
+    // Inicializa a fila da política escolhida
+    int erro;
+    if (politica_global == POLITICA_FIFO) {
+        if (capacidade == 0) capacidade = CAPACIDADE_PADRAO;
+        erro = inicializar_filas_impressoras(&filas_global, tamanho_pool, capacidade, distribuicao);
+        snprintf(evento, sizeof(evento), "Filas de impressão inicializadas (política FIFO, %d filas locais "
+                 "de %d trabalhos, distribuição %s)", tamanho_pool, capacidade,
+                 distribuicao == DISTRIBUICAO_RODIZIO ? "rodízio" : "menor carga");
+    } else {
+        if (capacidade == 0) capacidade = CAPACIDADE_PRIORIDADE_PADRAO;
+        erro = inicializar_fila_prioridade(&fila_prioridade_global, politica_global, capacidade,
+                                           envelhecimento_ms);
+        snprintf(evento, sizeof(evento), "Fila de impressão inicializada (política %s, %d trabalhos, "
+                 "envelhecimento %d ms)", politica_global == POLITICA_SJF ? "SJF" : "prioridade",
+                 capacidade, envelhecimento_ms);
+    }
+    if (erro != 0) {
+        fprintf(stderr, "Memória insuficiente para filas de %d trabalhos\n", capacidade);
+        exit(1);
+    }
+    log_evento(evento);
+    
+    // Diário: recupera o que ficou pendente na execução anterior
+    if (arquivo_diario != NULL) {
+        int maior_id;
+        if (abrir_diario(arquivo_diario, &trabalhos_recuperados, &num_recuperados, &maior_id) != 0) {
             exit(1);
         }
+        proximo_id_job = maior_id + 1;
+        snprintf(evento, sizeof(evento), "Diário aberto: %s (%d trabalhos pendentes)",
+                 arquivo_diario, num_recuperados);
+        log_evento(evento);
+    }
+    
+    // Cada impressora que sai avisa o encerramento por este eventfd; pelo outro,
+    // avisa a ingestão que abriu espaço para os lotes adiados
+    evento_impressoras = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    espaco_fila_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (evento_impressoras == -1 || espaco_fila_fd == -1) {
+        perror("Erro ao criar eventfd");
+        exit(1);
+    }
+    
+    // Canal de submissão por memória compartilhada (o pipe continua como alternativa)
+    memoria_global = criar_memoria_compartilhada(capacidade);
+    if (memoria_global != NULL) {
+        if (pthread_create(&thread_shm, NULL, thread_ingestao_shm, NULL) != 0) {
+            perror("Erro ao criar thread de ingestão");
+            liberar_memoria_compartilhada(memoria_global, 1);
+            memoria_global = NULL;
+        } else {
+            log_evento("Canal de memória compartilhada criado");
+        }
+    }
+    
+    // Cria as threads impressoras
+    definir_impressoras_ativas(num_impressoras);
+    if (impressoras_ativas == 0) {
+        exit(1);
     }
     
-    snprintf(evento, sizeof(evento), "%d threads impressoras criadas", MAX_IMPRESSORAS);
+    snprintf(evento, sizeof(evento), "%d threads impressoras criadas (tempo %s)", impressoras_ativas,
+             nome_modo_tempo());
     log_evento(evento);
+    
+    if (num_recuperados > 0 &&
+        pthread_create(&thread_recuperacao, NULL, thread_recuperar_diario, NULL) != 0) {
+        perror("Erro ao criar thread de recuperação do diário");
+        exit(1);
+    }
+    
+    if (max_impressoras > 0) {
+        if (pthread_create(&thread_autoescala, NULL, thread_autoescala_impressoras, NULL) != 0) {
+            perror("Erro ao criar thread de autoescala");
+            max_impressoras = 0;
+        } else {
+            snprintf(evento, sizeof(evento), "Autoescala ativa: %d a %d impressoras",
+                     min_impressoras, max_impressoras);
+            log_evento(evento);
+        }
+    }
 }
 
+// Demais fases do encerramento (a primeira é iniciar_encerramento), com o
+// tempo de cada uma no log e no console
 void finalizar_servidor() {
-    char evento[128];
+    char evento[256];
     
     log_evento("Iniciando finalização do servidor");
     
-    // Espera todas as threads terminarem
+    // Ingestão: espera as threads que ainda alimentam a fila (a autoescala primeiro: ela cria impressoras)
+    if (max_impressoras > 0) {
+        pthread_join(thread_autoescala, NULL);
+    }
+    if (memoria_global != NULL) {
+        pthread_join(thread_shm, NULL);
+    }
+    if (num_recuperados > 0) {
+        pthread_join(thread_recuperacao, NULL);
+    }
+    long long fim_ingestao_ns = instante_ns();
+    
+    // Impressoras: esvaziam a fila ou abortam
+    encerrar_filas_servidor();
+    aguardar_impressoras();
     for (int i = 0; i < MAX_IMPRESSORAS; i++) {
-        pthread_join(threads_impressoras[i], NULL);
+        if (threads_criadas[i]) {
+            pthread_join(threads_impressoras[i], NULL);
+        }
     }
+    long long fim_impressoras_ns = instante_ns();
+    
+    // Diário: grava as últimas conclusões; o que não foi impresso volta na próxima partida
+    int pendentes = fechar_diario(proximo_id_job - 1);
+    long long fim_diario_ns = instante_ns();
+    if (pendentes > 0) {
+        snprintf(evento, sizeof(evento), "Diário: %d trabalhos pendentes preservados para a próxima partida",
+                 pendentes);
+        log_evento(evento);
+        printf("%s\n", evento);
+    }
+    
+    // Remove o segmento compartilhado
+    liberar_memoria_compartilhada(memoria_global, 1);
+    memoria_global = NULL;
     
     // Destroi a fila
-    destruir_fila(&fila_global);
+    if (politica_global == POLITICA_FIFO) {
+        destruir_filas_impressoras(&filas_global);
+    } else {
+        destruir_fila_prioridade(&fila_prioridade_global);
+    }
     
-    // Remove o pipe
+    // Remove o pipe e o socket
     unlink(NOME_PIPE);
+    unlink(NOME_SOCKET);
+    close(evento_impressoras);
+    close(espaco_fila_fd);
+    long long fim_ns = instante_ns();
+    
+    // Resumo das métricas no console (e retrato final no arquivo)
+    finalizar_metricas(stdout);
     
-    snprintf(evento, sizeof(evento), "Servidor finalizado - total de trabalhos processados registrados no log");
+    snprintf(evento, sizeof(evento), "Encerramento (%s): ingestão %.1f ms, impressoras %.1f ms, "
+             "diário %.1f ms, recursos %.1f ms, total %.1f ms",
+             modo_encerramento == ENCERRAMENTO_DRENAR ? "drenagem" : "abortado",
+             (fim_ingestao_ns - inicio_encerramento_ns) / 1e6, (fim_impressoras_ns - fim_ingestao_ns) / 1e6,
+             (fim_diario_ns - fim_impressoras_ns) / 1e6, (fim_ns - fim_diario_ns) / 1e6,
+             (fim_ns - inicio_encerramento_ns) / 1e6);
+    log_evento(evento);
+    printf("%s\n", evento);
+    
+    snprintf(evento, sizeof(evento), "Servidor finalizado - %llu trabalhos impressos de %llu recebidos",
+             metricas_trabalhos_impressos(), metricas_trabalhos_recebidos());
     log_evento(evento);
     
     printf("Servidor finalizado com sucesso\n");
 }
 
-void processar_trabalhos() {
-    TrabalhoImpressao trabalho;
-    char evento[256];
+// Cria a fonte e a registra no epoll
+FonteIngestao* adicionar_fonte(int epoll_fd, TipoFonte tipo, int fd) {
+    FonteIngestao *fonte = calloc(1, sizeof(FonteIngestao));
+    if (fonte == NULL) return NULL;
     
-    log_evento("Servidor iniciado - aguardando trabalhos de impressão");
-    printf("Servidor iniciado. Aguardando trabalhos...\n");
-    printf("Use Ctrl+C para finalizar o servidor\n");
+    fonte->tipo = tipo;
+    fonte->fd = fd;
+    fonte->lendo = 1;
+    fonte->eventos = EPOLLIN;
+    
+    struct epoll_event evento = { .events = EPOLLIN, .data.ptr = fonte };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &evento) == -1) {
+        free(fonte);
+        return NULL;
+    }
+    
+    fonte->proxima = fontes_abertas;
+    if (fontes_abertas != NULL) fontes_abertas->anterior = fonte;
+    fontes_abertas = fonte;
+    return fonte;
+}
+
+// Põe a fonte no fim da espera por espaço na fila (ordem em que encheram a fila)
+void esperar_espaco(FonteIngestao *fonte) {
+    fonte->proxima_espera = NULL;
+    if (espera_fim != NULL) espera_fim->proxima_espera = fonte;
+    else espera_inicio = fonte;
+    espera_fim = fonte;
+}
+
+// Tira da espera uma fonte que vai ser removida com lotes adiados
+void deixar_espera(FonteIngestao *fonte) {
+    FonteIngestao *anterior = NULL;
+    for (FonteIngestao *atual = espera_inicio; atual != NULL; atual = atual->proxima_espera) {
+        if (atual == fonte) {
+            if (anterior != NULL) anterior->proxima_espera = fonte->proxima_espera;
+            else espera_inicio = fonte->proxima_espera;
+            if (espera_fim == fonte) espera_fim = anterior;
+            return;
+        }
+        anterior = atual;
+    }
+}
+
+void remover_fonte(int epoll_fd, FonteIngestao *fonte) {
+    if (fonte->anterior != NULL) fonte->anterior->proxima = fonte->proxima;
+    else fontes_abertas = fonte->proxima;
+    if (fonte->proxima != NULL) fonte->proxima->anterior = fonte->anterior;
+    if (fonte->num_adiados > 0) deixar_espera(fonte);
+    
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fonte->fd, NULL);
+    close(fonte->fd);
+    free(fonte->confirmacoes);
+    free(fonte->adiados);
+    free(fonte);
+}
+
+// Confirmações que o próximo group commit decide: as do lote com adiados só
+// depois que todos entrarem na fila
+size_t confirmacoes_prontas(FonteIngestao *fonte) {
+    return fonte->num_adiados > 0 ? fonte->lote_adiado : fonte->total_confirmacoes;
+}
+
+// Ajusta os eventos da fonte: deixa de ler enquanto há lotes adiados ou
+// confirmações demais acumuladas (o cliente não as está lendo) e espera
+// EPOLLOUT para enviar as já decididas
+void atualizar_eventos(int epoll_fd, FonteIngestao *fonte) {
+    size_t pendentes = fonte->total_confirmacoes - fonte->bytes_enviados / sizeof(ConfirmacaoTrabalho);
+    fonte->lendo = fonte->num_adiados == 0 && pendentes < LIMITE_CONFIRMACOES;
+    
+    struct epoll_event evento = { .events = 0, .data.ptr = fonte };
+    if (fonte->lendo) evento.events |= EPOLLIN;
+    if (fonte->bytes_enviados < fonte->confirmacoes_decididas * sizeof(ConfirmacaoTrabalho)) {
+        evento.events |= EPOLLOUT;
+    }
+    if (evento.events == fonte->eventos) return;
+    fonte->eventos = evento.events;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fonte->fd, &evento);
+}
+
+// Envia o que couber das confirmações decididas; -1 se o cliente desconectou
+int enviar_confirmacoes(FonteIngestao *fonte) {
+    const char *dados = (const char *)fonte->confirmacoes;
+    size_t total = fonte->confirmacoes_decididas * sizeof(ConfirmacaoTrabalho);
+    
+    while (fonte->bytes_enviados < total) {
+        ssize_t enviados = send(fonte->fd, dados + fonte->bytes_enviados, total - fonte->bytes_enviados,
+                                MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (enviados == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        fonte->bytes_enviados += enviados;
+    }
     
-    // Abre o pipe para leitura
-    pipe_fd = open(NOME_PIPE, O_RDONLY);
+    // O vetor recomeça quando não resta lote adiado à espera de confirmação
+    if (fonte->confirmacoes_decididas == fonte->total_confirmacoes) {
+        fonte->bytes_enviados = 0;
+        fonte->total_confirmacoes = 0;
+        fonte->confirmacoes_decididas = 0;
+    }
+    return 0;
+}
+
+// Enfileira sem bloquear o que couber de trabalhos já registrados; o resto fica
+// em fonte->adiados e a fonte para de ler até uma impressora abrir espaço
+// (retomar_adiados). Assim um cliente rápido não trava a ingestão dos outros
+// nem o signalfd. Retorna -1 se falta memória para guardar os adiados.
+int enfileirar_sem_bloquear(FonteIngestao *fonte, TrabalhoImpressao *trabalhos, int quantidade) {
+    int enfileirados = tentar_colocar_na_fila(trabalhos, quantidade);
+    if (enfileirados < quantidade) {
+        // Marca a espera e tenta de novo: quem retirou antes da marca não avisou
+        __atomic_store_n(&ingestao_esperando_espaco, 1, __ATOMIC_SEQ_CST);
+        enfileirados += tentar_colocar_na_fila(trabalhos + enfileirados, quantidade - enfileirados);
+    }
+    if (enfileirados > 0) {
+        contabilizar_lote(trabalhos, enfileirados, enfileirados);
+    }
+    
+    int restantes = quantidade - enfileirados;
+    if (restantes == 0) {
+        free(fonte->adiados);
+        fonte->adiados = NULL;
+    } else {
+        if (fonte->adiados == NULL) {
+            fonte->adiados = malloc(sizeof(TrabalhoImpressao) * restantes);
+            if (fonte->adiados == NULL) return -1;
+        }
+        memmove(fonte->adiados, trabalhos + enfileirados, sizeof(TrabalhoImpressao) * restantes);
+    }
+    fonte->num_adiados = restantes;
+    return 0;
+}
+
+// Põe o cliente na lista do group commit desta rodada (uma vez só)
+void incluir_na_rodada(FonteIngestao **rodada, FonteIngestao *fonte) {
+    if (fonte->na_rodada) return;
+    fonte->na_rodada = 1;
+    fonte->proxima_rodada = *rodada;
+    *rodada = fonte;
+}
+
+// Uma impressora abriu espaço: tenta de novo os lotes adiados, na ordem em que
+// encheram a fila. As fontes que esvaziaram os seus voltam a ler, e os
+// clientes entram no group commit da rodada.
+void retomar_adiados(int epoll_fd, FonteIngestao **rodada) {
+    while (espera_inicio != NULL) {
+        FonteIngestao *fonte = espera_inicio;
+        enfileirar_sem_bloquear(fonte, fonte->adiados, fonte->num_adiados);
+        if (fonte->num_adiados > 0) break;      // A fila encheu de novo
+        
+        espera_inicio = fonte->proxima_espera;
+        if (espera_inicio == NULL) espera_fim = NULL;
+        
+        if (fonte->tipo == FONTE_CLIENTE) {
+            incluir_na_rodada(rodada, fonte);
+        } else {
+            atualizar_eventos(epoll_fd, fonte);
+        }
+    }
+}
+
+// Lê um bloco da fonte, registra os registros completos e os enfileira sem bloquear.
+// Retorna -1 se a fonte deve ser removida (cliente desconectou ou erro).
+int ler_fonte(FonteIngestao *fonte, TrabalhoImpressao *lote) {
+    char *bytes = (char *)lote;
+    size_t capacidade = LOTE_INGESTAO * sizeof(TrabalhoImpressao);
+    
+    // O pedaço de registro da leitura anterior vai na frente do bloco
+    memcpy(bytes, fonte->resto, fonte->tamanho_resto);
+    size_t pendentes = fonte->tamanho_resto;
+    
+    ssize_t bytes_lidos = read(fonte->fd, bytes + pendentes, capacidade - pendentes);
+    if (bytes_lidos == 0) return -1;
+    if (bytes_lidos == -1) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    pendentes += bytes_lidos;
+    
+    int completos = pendentes / sizeof(TrabalhoImpressao);
+    fonte->tamanho_resto = pendentes - completos * sizeof(TrabalhoImpressao);
+    memcpy(fonte->resto, bytes + completos * sizeof(TrabalhoImpressao), fonte->tamanho_resto);
+    if (completos == 0) return 0;
+    
+    // Clientes: reserva espaço e registra uma confirmação por trabalho
+    ConfirmacaoTrabalho *confirmacoes = NULL;
+    if (fonte->tipo == FONTE_CLIENTE) {
+        size_t necessario = fonte->total_confirmacoes + completos;
+        if (necessario > fonte->capacidade_confirmacoes) {
+            size_t nova = fonte->capacidade_confirmacoes ? fonte->capacidade_confirmacoes : LOTE_INGESTAO;
+            while (nova < necessario) nova *= 2;
+            ConfirmacaoTrabalho *maior = realloc(fonte->confirmacoes, nova * sizeof(ConfirmacaoTrabalho));
+            if (maior == NULL) return -1;
+            fonte->confirmacoes = maior;
+            fonte->capacidade_confirmacoes = nova;
+        }
+        confirmacoes = fonte->confirmacoes + fonte->total_confirmacoes;
+        fonte->lote_adiado = fonte->total_confirmacoes;
+        fonte->total_confirmacoes += completos;
+    }
+    
+    // As confirmações saem depois que o diário gravar o lote (processar_trabalhos)
+    registrar_lote(lote, completos, confirmacoes);
+    if (enfileirar_sem_bloquear(fonte, lote, completos) != 0) return -1;
+    if (fonte->num_adiados > 0) esperar_espaco(fonte);
+    return 0;
+}
+
+// Aceita todas as conexões pendentes no socket de escuta
+void aceitar_clientes(int epoll_fd, int socket_fd) {
+    char evento[128];
+    
+    for (;;) {
+        int fd = accept4(socket_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("Erro ao aceitar cliente");
+            return;
+        }
+        
+        if (adicionar_fonte(epoll_fd, FONTE_CLIENTE, fd) == NULL) {
+            close(fd);
+            continue;
+        }
+        snprintf(evento, sizeof(evento), "Cliente conectado pelo socket (fd %d)", fd);
+        log_evento(evento);
+    }
+}
+
+// Ingestão: multiplexa com epoll o socket de escuta, os clientes conectados, o
+// pipe e o signalfd. SIGINT/SIGTERM chegam como leitura no signalfd, e o
+// encerramento começa aqui mesmo, fora de contexto de sinal.
+void processar_trabalhos(void) {
+    TrabalhoImpressao lote[LOTE_INGESTAO];
+    struct epoll_event eventos[EVENTOS_EPOLL];
+    
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("Erro ao criar epoll");
+        return;
+    }
+    
+    int socket_fd = criar_socket();
+    FonteIngestao *escuta = socket_fd == -1 ? NULL : adicionar_fonte(epoll_fd, FONTE_ESCUTA, socket_fd);
+    
+    // O pipe é aberto para leitura e escrita: sempre há um escritor, então o
+    // servidor não recebe EOF nem precisa reabri-lo quando os clientes fecham
+    int pipe_fd = open(NOME_PIPE, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    FonteIngestao *pipe_fonte = pipe_fd == -1 ? NULL : adicionar_fonte(epoll_fd, FONTE_PIPE, pipe_fd);
     if (pipe_fd == -1) {
         perror("Erro ao abrir pipe para leitura");
+    }
+    
+    // O signalfd não é uma fonte de trabalhos: entra no epoll com data.ptr NULL.
+    // O eventfd de espaço na fila fica fora da lista de fontes abertas.
+    struct epoll_event evento_sinal = { .events = EPOLLIN, .data.ptr = NULL };
+    fonte_espaco.fd = espaco_fila_fd;
+    struct epoll_event evento_espaco = { .events = EPOLLIN, .data.ptr = &fonte_espaco };
+    if ((escuta == NULL && pipe_fonte == NULL) ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sinal_fd, &evento_sinal) == -1 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, espaco_fila_fd, &evento_espaco) == -1) {
+        while (fontes_abertas != NULL) remover_fonte(epoll_fd, fontes_abertas);
+        close(epoll_fd);
         return;
     }
     
+    log_evento("Servidor iniciado - aguardando trabalhos de impressão");
+    printf("Servidor iniciado. Aguardando trabalhos...\n");
+    printf("Use Ctrl+C para finalizar o servidor\n");
+    
+    int falha_diario_registrada = 0;
     while (servidor_ativo) {
-        ssize_t bytes_lidos = read(pipe_fd, &trabalho, sizeof(TrabalhoImpressao));
+        FonteIngestao *rodada = NULL;   // Clientes com confirmações para o group commit
+        int espaco_liberado = 0;
         
-        if (bytes_lidos == sizeof(TrabalhoImpressao)) {
-            // Trabalho recebido com sucesso
-            snprintf(evento, sizeof(evento), 
-                     "Trabalho recebido - ID: %d, Arquivo: %s, Páginas: %d",
-                     trabalho.id_job, trabalho.nome_arquivo, trabalho.numero_paginas);
-            log_evento(evento);
+        int prontos = epoll_wait(epoll_fd, eventos, EVENTOS_EPOLL, -1);
+        if (prontos == -1) {
+            if (errno == EINTR) continue;
+            perror("Erro no epoll_wait");
+            break;
+        }
+        
+        for (int i = 0; i < prontos && servidor_ativo; i++) {
+            FonteIngestao *fonte = eventos[i].data.ptr;
             
-            printf("Trabalho recebido: ID %d, Arquivo: %s, Páginas: %d\n",
-                   trabalho.id_job, trabalho.nome_arquivo, trabalho.numero_paginas);
+            if (fonte == NULL) {
+                int sinal = ler_sinal();
+                if (sinal != 0) iniciar_encerramento(sinal);
+                continue;
+            }
             
-            // Enfileira o trabalho
-            if (enfileirar_trabalho(&fila_global, trabalho) == 0) {
-                snprintf(evento, sizeof(evento), "Trabalho %d enfileirado com sucesso", trabalho.id_job);
-                log_evento(evento);
-            } else {
-                snprintf(evento, sizeof(evento), "Erro ao enfileirar trabalho %d", trabalho.id_job);
-                log_evento(evento);
+            if (fonte->tipo == FONTE_ESCUTA) {
+                aceitar_clientes(epoll_fd, fonte->fd);
+                continue;
             }
-        } else if (bytes_lidos == 0) {
-            // EOF - pipe foi fechado pelo último cliente
-            printf("Pipe fechado - aguardando novos clientes...\n");
-            close(pipe_fd);
             
-            // Reabre o pipe
-            pipe_fd = open(NOME_PIPE, O_RDONLY);
-            if (pipe_fd == -1) {
-                if (servidor_ativo) {
-                    perror("Erro ao reabrir pipe");
+            if (fonte->tipo == FONTE_ESPACO) {
+                uint64_t avisos;
+                if (read(espaco_fila_fd, &avisos, sizeof(avisos)) == -1 && errno != EAGAIN) {
+                    perror("Erro ao ler aviso de espaço na fila");
                 }
-                break;
+                espaco_liberado = 1;
+                continue;
+            }
+            
+            int resultado = 0;
+            if (eventos[i].events & EPOLLOUT) {
+                resultado = enviar_confirmacoes(fonte);
+            }
+            if (resultado == 0 && fonte->lendo && (eventos[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                resultado = ler_fonte(fonte, lote);
+            } else if (resultado == 0 && (eventos[i].events & (EPOLLHUP | EPOLLERR))) {
+                resultado = -1;     // Parada sem nada a enviar: a conexão caiu
             }
-        } else if (bytes_lidos == -1) {
-            // Erro na leitura
-            if (servidor_ativo) {
+            
+            if (resultado == -1 && fonte->tipo == FONTE_CLIENTE) {
+                char evento[128];
+                snprintf(evento, sizeof(evento), "Cliente desconectado (fd %d)", fonte->fd);
+                log_evento(evento);
+                remover_fonte(epoll_fd, fonte);
+            } else if (resultado == -1) {
                 perror("Erro ao ler do pipe");
+                remover_fonte(epoll_fd, fonte);
+            } else if (fonte->tipo == FONTE_CLIENTE && fonte->total_confirmacoes > 0) {
+                incluir_na_rodada(&rodada, fonte);
+            } else {
+                atualizar_eventos(epoll_fd, fonte);
+            }
+        }
+        
+        // As impressoras abriram espaço: os lotes adiados entram na fila antes do group commit
+        if (espaco_liberado && servidor_ativo) {
+            retomar_adiados(epoll_fd, &rodada);
+        }
+        
+        // Group commit: um único fdatasync cobre os lotes de todos os clientes
+        // desta rodada, e só então eles recebem as confirmações. Se o diário
+        // falhou, os lotes da rodada não estão garantidos e vão como recusados
+        // (mesmo já na fila: o cliente pode reenviar e imprimir duas vezes).
+        int diario_falhou = rodada != NULL && diario_aguardar(diario_ultimo_registro()) == -1;
+        if (diario_falhou) {
+            size_t recusados = 0;
+            for (FonteIngestao *fonte = rodada; fonte != NULL; fonte = fonte->proxima_rodada) {
+                size_t prontas = confirmacoes_prontas(fonte);
+                for (size_t j = fonte->confirmacoes_decididas; j < prontas; j++) {
+                    fonte->confirmacoes[j].status = -1;
+                    recusados++;
+                }
+            }
+            
+            // Só a primeira rodada: depois da falha todas as seguintes recusam
+            if (!falha_diario_registrada) {
+                char evento[128];
+                snprintf(evento, sizeof(evento),
+                         "Falha no diário: %zu trabalhos recusados aos clientes (e todos os próximos)", recusados);
+                log_evento(evento);
+                fprintf(stderr, "%s\n", evento);
+                falha_diario_registrada = 1;
+            }
+        }
+        while (rodada != NULL) {
+            FonteIngestao *fonte = rodada;
+            rodada = fonte->proxima_rodada;
+            fonte->na_rodada = 0;
+            fonte->confirmacoes_decididas = confirmacoes_prontas(fonte);
+            if (enviar_confirmacoes(fonte) == -1) {
+                char evento[128];
+                snprintf(evento, sizeof(evento), "Cliente desconectado (fd %d)", fonte->fd);
+                log_evento(evento);
+                remover_fonte(epoll_fd, fonte);
+            } else {
+                atualizar_eventos(epoll_fd, fonte);
             }
-            break;
         }
     }
     
-    if (pipe_fd != -1) {
-        close(pipe_fd);
+    // Os lotes adiados já estão registrados: na drenagem esperam espaço na fila
+    // como as outras ingestões; abortando, a fila fechada os recusa (e eles
+    // ficam pendentes no diário)
+    while (espera_inicio != NULL) {
+        FonteIngestao *fonte = espera_inicio;
+        espera_inicio = fonte->proxima_espera;
+        int enfileirados = colocar_na_fila(fonte->adiados, fonte->num_adiados);
+        contabilizar_lote(fonte->adiados, fonte->num_adiados, enfileirados);
+        fonte->num_adiados = 0;
     }
+    espera_fim = NULL;
+    
+    // Fecha o socket de escuta, o pipe e as conexões: os clientes veem o fim da
+    // conexão em vez de esperar confirmações durante a drenagem
+    while (fontes_abertas != NULL) remover_fonte(epoll_fd, fontes_abertas);
+    close(epoll_fd);
 }
 
-int main() {
+void exibir_uso(const char *programa) {
+    fprintf(stderr, "Uso: %s [opções]\n", programa);
+    fprintf(stderr, "  --log-intervalo MS    Intervalo entre descargas do log (padrão %d)\n",
+            LOG_INTERVALO_PADRAO_MS);
+    fprintf(stderr, "  --politica P          fifo (padrão), prioridade ou sjf\n");
+    fprintf(stderr, "  --envelhecimento MS   Espera que vale um nível de prioridade ou uma página (padrão %d)\n",
+            ENVELHECIMENTO_PADRAO_MS);
+    fprintf(stderr, "  --distribuicao D      rodizio ou menor-carga (padrão), na política fifo\n");
+    fprintf(stderr, "  --impressoras N       Impressoras na partida (padrão %d, máximo %d)\n",
+            IMPRESSORAS_PADRAO, MAX_IMPRESSORAS);
+    fprintf(stderr, "  --capacidade N        Trabalhos por fila (padrão %d; %d em prioridade/sjf)\n",
+            CAPACIDADE_PADRAO, CAPACIDADE_PRIORIDADE_PADRAO);
+    fprintf(stderr, "  --autoescala MIN:MAX  Ajusta o número de impressoras à carga\n");
+    fprintf(stderr, "  --encerramento M      drenar (padrão: imprime a fila antes de sair) ou abortar\n");
+    fprintf(stderr, "  --diario ARQ          Diário dos trabalhos aceitos (padrão %s)\n", ARQUIVO_DIARIO);
+    fprintf(stderr, "  --sem-diario          Não grava o diário (a fila se perde ao encerrar)\n");
+    fprintf(stderr, "  --metricas ARQ        Arquivo dos retratos de métricas (padrão %s)\n", ARQUIVO_METRICAS);
+    fprintf(stderr, "  --metricas-intervalo MS  Intervalo entre retratos (padrão %d; 0 desliga)\n",
+            METRICAS_INTERVALO_PADRAO_MS);
+    fprintf(stderr, "  --tempo M             real (padrão: 1 s por página), escalado ou virtual\n");
+    fprintf(stderr, "  --pagina-us US        Duração de uma página no tempo escalado (padrão %d)\n",
+            US_POR_PAGINA_ESCALADO_PADRAO);
+}
+
+int main(int argc, char *argv[]) {
+    int intervalo_log_ms = LOG_INTERVALO_PADRAO_MS;
+    int envelhecimento_ms = ENVELHECIMENTO_PADRAO_MS;
+    DistribuicaoFila distribuicao = DISTRIBUICAO_MENOR_CARGA;
+    int capacidade = 0;     // 0: padrão da política
+    const char *arquivo_metricas = ARQUIVO_METRICAS;
+    const char *arquivo_diario = ARQUIVO_DIARIO;
+    int intervalo_metricas_ms = METRICAS_INTERVALO_PADRAO_MS;
+    ModoTempo modo_tempo = TEMPO_REAL;
+    long long us_por_pagina = 0;     // 0: padrão do tempo escalado
+    
+    // Opções de linha de comando
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log-intervalo") == 0 && i + 1 < argc) {
+            intervalo_log_ms = atoi(argv[++i]);
+            if (intervalo_log_ms <= 0) {
+                fprintf(stderr, "Intervalo de log inválido: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--politica") == 0 && i + 1 < argc) {
+            const char *nome = argv[++i];
+            if (strcmp(nome, "fifo") == 0) {
+                politica_global = POLITICA_FIFO;
+            } else if (strcmp(nome, "prioridade") == 0) {
+                politica_global = POLITICA_PRIORIDADE;
+            } else if (strcmp(nome, "sjf") == 0) {
+                politica_global = POLITICA_SJF;
+            } else {
+                fprintf(stderr, "Política inválida: %s (use fifo, prioridade ou sjf)\n", nome);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--distribuicao") == 0 && i + 1 < argc) {
+            const char *nome = argv[++i];
+            if (strcmp(nome, "rodizio") == 0) {
+                distribuicao = DISTRIBUICAO_RODIZIO;
+            } else if (strcmp(nome, "menor-carga") == 0) {
+                distribuicao = DISTRIBUICAO_MENOR_CARGA;
+            } else {
+                fprintf(stderr, "Distribuição inválida: %s (use rodizio ou menor-carga)\n", nome);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--envelhecimento") == 0 && i + 1 < argc) {
+            envelhecimento_ms = atoi(argv[++i]);
+            if (envelhecimento_ms < 0) {
+                fprintf(stderr, "Envelhecimento inválido: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--impressoras") == 0 && i + 1 < argc) {
+            num_impressoras = atoi(argv[++i]);
+            if (num_impressoras < 1 || num_impressoras > MAX_IMPRESSORAS) {
+                fprintf(stderr, "Número de impressoras inválido: %s (1 a %d)\n", argv[i], MAX_IMPRESSORAS);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--capacidade") == 0 && i + 1 < argc) {
+            capacidade = atoi(argv[++i]);
+            if (capacidade < 1) {
+                fprintf(stderr, "Capacidade inválida: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--autoescala") == 0 && i + 1 < argc) {
+            char resto = '\0';
+            if (sscanf(argv[++i], "%d:%d%c", &min_impressoras, &max_impressoras, &resto) != 2 ||
+                min_impressoras < 1 || min_impressoras > max_impressoras || max_impressoras > MAX_IMPRESSORAS) {
+                fprintf(stderr, "Autoescala inválida: %s (use MIN:MAX, 1 a %d)\n", argv[i], MAX_IMPRESSORAS);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--encerramento") == 0 && i + 1 < argc) {
+            const char *nome = argv[++i];
+            if (strcmp(nome, "drenar") == 0) {
+                modo_encerramento = ENCERRAMENTO_DRENAR;
+            } else if (strcmp(nome, "abortar") == 0) {
+                modo_encerramento = ENCERRAMENTO_ABORTAR;
+            } else {
+                fprintf(stderr, "Modo de encerramento inválido: %s (use drenar ou abortar)\n", nome);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--diario") == 0 && i + 1 < argc) {
+            arquivo_diario = argv[++i];
+        } else if (strcmp(argv[i], "--sem-diario") == 0) {
+            arquivo_diario = NULL;
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            arquivo_metricas = argv[++i];
+        } else if (strcmp(argv[i], "--metricas-intervalo") == 0 && i + 1 < argc) {
+            intervalo_metricas_ms = atoi(argv[++i]);
+            if (intervalo_metricas_ms < 0) {
+                fprintf(stderr, "Intervalo de métricas inválido: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--tempo") == 0 && i + 1 < argc) {
+            const char *nome = argv[++i];
+            if (strcmp(nome, "real") == 0) {
+                modo_tempo = TEMPO_REAL;
+            } else if (strcmp(nome, "escalado") == 0) {
+                modo_tempo = TEMPO_ESCALADO;
+            } else if (strcmp(nome, "virtual") == 0) {
+                modo_tempo = TEMPO_VIRTUAL;
+            } else {
+                fprintf(stderr, "Modo de tempo inválido: %s (use real, escalado ou virtual)\n", nome);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--pagina-us") == 0 && i + 1 < argc) {
+            us_por_pagina = atoll(argv[++i]);
+            if (us_por_pagina < 1) {
+                fprintf(stderr, "Duração de página inválida: %s\n", argv[i]);
+                exit(1);
+            }
+        } else {
+            exibir_uso(argv[0]);
+            exit(1);
+        }
+    }
+    
+    // Com autoescala, o pool inicial fica dentro dos limites
+    if (max_impressoras > 0) {
+        if (num_impressoras < min_impressoras) num_impressoras = min_impressoras;
+        if (num_impressoras > max_impressoras) num_impressoras = max_impressoras;
+    }
+    
     printf("=== Sistema de Gerenciamento de Fila de Impressão ===\n");
     printf("Inicializando servidor...\n");
     
     // Limpa o arquivo de log
-    FILE* log_file = fopen("log_servidor.txt", "w");
+    FILE* log_file = fopen(ARQUIVO_LOG, "w");
     if (log_file) {
         fclose(log_file);
     }
     
+    // SIGINT/SIGTERM ficam bloqueados em todas as threads (as auxiliares herdam a
+    // máscara) e só são lidos pelo signalfd, na ingestão e no encerramento
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+    sinal_fd = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sinal_fd == -1) {
+        perror("Erro ao criar signalfd");
+        exit(1);
+    }
+    
+    // Log assíncrono: as threads só escrevem em memória
+    if (inicializar_log(ARQUIVO_LOG, intervalo_log_ms) != 0) {
+        exit(1);
+    }
+    
+    // Backend das impressoras: define o relógio usado pelas métricas
+    if (configurar_impressoras(modo_tempo, us_por_pagina) != 0) {
+        exit(1);
+    }
+    
+    // Métricas: contadores em memória e retratos periódicos no arquivo
+    if (inicializar_metricas(arquivo_metricas, intervalo_metricas_ms) != 0) {
+        exit(1);
+    }
+    
     // Cria o pipe
     if (criar_pipe() != 0) {
         exit(1);
     }
     
     // Inicializa o servidor
-    inicializar_servidor();
+    inicializar_servidor(envelhecimento_ms, distribuicao, capacidade, arquivo_diario);
     
-    // Processa trabalhos
+    // Processa trabalhos até um sinal (ou erro na ingestão)
     processar_trabalhos();
+    if (servidor_ativo) {
+        iniciar_encerramento(0);
+    }
     
     // Finaliza o servidor
     finalizar_servidor();
     
+    // Garante que todos os eventos chegaram ao arquivo
+    finalizar_log();
+    close(sinal_fd);
+    
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef CARGA_TRABALHO_H
+#define CARGA_TRABALHO_H
+
+#include "TabelaProcessos.h"
+#include <vector>
+
+/**
+ * @brief Carga de trabalho imutável compartilhada pelos escalonadores
+ *
+ * Guarda a tabela de processos e o índice de chegada, calculado uma única
+ * vez na construção. Os escalonadores recebem a mesma instância por
+ * std::shared_ptr<const CargaTrabalho> e mantêm apenas o próprio estado
+ * de execução.
+ */
+class CargaTrabalho {
+private:
+    TabelaProcessos tabela;
+    std::vector<int> ordemChegada;  // Índices com CPU a cumprir, ordenados por chegada
+    long long tempoCPUTotal;        // Soma dos tempos de CPU de todos os processos
+
+public:
+    /**
+     * @brief Constrói a carga assumindo a tabela e indexando as chegadas
+     */
+    explicit CargaTrabalho(TabelaProcessos tabela = TabelaProcessos());
+
+    const TabelaProcessos& getTabela() const { return tabela; }
+    const std::vector<int>& getOrdemChegada() const { return ordemChegada; }
+    long long getTempoCPUTotal() const { return tempoCPUTotal; }
+    size_t tamanho() const { return tabela.tamanho(); }
+    bool vazia() const { return tabela.vazia(); }
+};
+
+#endif // CARGA_TRABALHO_H
@@ -2,9 +2,13 @@
 #define ESCALONADOR_H
 
 #include "Processo.h"
+#include "CargaTrabalho.h"
 #include <vector>
 #include <queue>
+#include <functional>
+#include <deque>
 #include <string>
+#include <memory>
 
 /**
  * @brief Estrutura para armazenar estatísticas da simulação
@@ -20,16 +24,43 @@ struct Estatisticas {
                     tempoMedioResposta(0), utilizacaoCPU(0), throughput(0) {}
 };
 
+/**
+ * @brief Entrada da fila de prontos ordenada por chave (heap binário)
+ */
+struct EntradaPronto {
+    int chave;          // Critério principal (burst, tempo restante ou prioridade)
+    int desempate;      // Critério secundário (tempo de chegada, quando usado)
+    int indice;         // Posição na tabela, mantém o desempate por ordem FCFS
+
+    bool operator>(const EntradaPronto& outra) const {
+        if (chave != outra.chave) return chave > outra.chave;
+        if (desempate != outra.desempate) return desempate > outra.desempate;
+        return indice > outra.indice;
+    }
+};
+
+using HeapProntos = std::priority_queue<EntradaPronto, std::vector<EntradaPronto>,
+                                        std::greater<EntradaPronto>>;
+
 /**
  * @brief Classe base abstrata para algoritmos de escalonamento
  */
 class Escalonador {
 protected:
-    std::vector<Processo> processos;
-    std::vector<Processo> processosOriginais; // Para reiniciar simulações
+    std::shared_ptr<const CargaTrabalho> carga;  // Compartilhada, somente leitura
+    
+    // Estado da execução, um vetor por campo, indexado como a tabela
+    std::vector<int> tempoRestante;
+    std::vector<int> tempoInicioExecucao;  // -1 até a primeira execução
+    std::vector<int> tempoFinalizacao;     // -1 até terminar
+    
+    size_t cursorChegada;           // Próxima posição do índice de chegada a admitir
+    int processosConcluidos;
+    int processosAExecutar;         // Processos com tempo de CPU a cumprir
     int tempoAtual;
     int quantum; // Para Round Robin
     std::string nomeAlgoritmo;
+    bool verboso; // Exibe o andamento da simulação no console
 
 public:
     /**
@@ -43,9 +74,31 @@ public:
     virtual ~Escalonador() = default;
 
     /**
-     * @brief Adiciona um processo à lista
+     * @brief Cria um escalonador do mesmo algoritmo e parâmetros, sem carga
      */
-    void adicionarProcesso(const Processo& processo);
+    virtual std::unique_ptr<Escalonador> clonar() const = 0;
+
+    /**
+     * @brief Nomes dos parâmetros ajustáveis do algoritmo (ex.: "quantum")
+     */
+    virtual std::vector<std::string> getParametros() const { return {}; }
+
+    /**
+     * @brief Ajusta um parâmetro pelo nome
+     * @return false se o algoritmo não tem o parâmetro ou o valor é inválido
+     */
+    virtual bool setParametro(const std::string&, int) { return false; }
+
+    /**
+     * @brief Define a carga de trabalho (compartilhada entre escalonadores)
+     */
+    void setCarga(std::shared_ptr<const CargaTrabalho> novaCarga);
+    const std::shared_ptr<const CargaTrabalho>& getCarga() const { return carga; }
+
+    /**
+     * @brief Monta o processo i com o resultado da última simulação
+     */
+    Processo obterProcesso(size_t i) const;
 
     /**
      * @brief Executa a simulação do algoritmo de escalonamento
@@ -74,22 +127,70 @@ public:
     std::string getNomeAlgoritmo() const { return nomeAlgoritmo; }
     int getQuantum() const { return quantum; }
     void setQuantum(int q) { quantum = q; }
+    virtual bool usaQuantum() const { return false; }
+    bool getVerboso() const { return verboso; }
+    void setVerboso(bool v) { verboso = v; }
 
 protected:
     /**
-     * @brief Verifica se há processos que chegaram no tempo atual
+     * @brief Motor de simulação orientado a eventos
+     *
+     * Avança o relógio direto para o próximo ponto de decisão (próxima
+     * chegada do índice ordenado, conclusão ou fim de quantum) em vez de
+     * passo a passo, consultando a política do algoritmo pelos métodos abaixo.
+     */
+    Estatisticas simularEventos();
+
+    /**
+     * @brief Tabela de processos da carga atual
+     */
+    const TabelaProcessos& tabela() const { return carga->getTabela(); }
+
+    /**
+     * @brief Esvazia a estrutura de prontos do algoritmo
+     */
+    virtual void limparProntos() = 0;
+
+    /**
+     * @brief Insere um processo na estrutura de prontos
+     */
+    virtual void inserirPronto(int processo) = 0;
+
+    /**
+     * @brief Remove e retorna o próximo processo a executar (-1 se vazio)
+     */
+    virtual int selecionarProximo() = 0;
+
+    /**
+     * @brief Duração máxima da próxima fatia de execução do processo
+     */
+    virtual int duracaoFatia(int processo) const { return tempoRestante[processo]; }
+
+    /**
+     * @brief Indica se uma chegada interrompe o processo em execução
+     */
+    virtual bool preemptivo() const { return false; }
+
+    /**
+     * @brief Admite na fila de prontos os processos que chegaram até o tempo atual
+     * @return true se algum processo foi admitido
+     */
+    bool admitirChegadas();
+
+    /**
+     * @brief Tempo da próxima chegada ainda não admitida (INT_MAX se não houver)
      */
-    std::vector<Processo*> obterProcessosChegando();
+    int proximaChegada() const;
 
     /**
      * @brief Verifica se todos os processos terminaram
      */
-    bool todosProcessosTerminaram() const;
+    bool todosProcessosTerminaram() const { return processosConcluidos == processosAExecutar; }
 
     /**
      * @brief Exibe o estado atual da simulação
      */
-    void exibirEstadoAtual(const Processo* processoAtual = nullptr) const;
+    void exibirEstadoAtual(int processoAtual = -1) const;
 };
 
 /**
@@ -99,6 +200,15 @@ class FCFS : public Escalonador {
 public:
     FCFS() : Escalonador("FCFS") {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<FCFS>(); }
+
+protected:
+    void limparProntos() override { filaReady.clear(); }
+    void inserirPronto(int processo) override { filaReady.push_back(processo); }
+    int selecionarProximo() override;
+
+private:
+    std::deque<int> filaReady;
 };
 
 /**
@@ -108,6 +218,15 @@ class SJF : public Escalonador {
 public:
     SJF() : Escalonador("SJF") {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<SJF>(); }
+
+protected:
+    void limparProntos() override { prontos = HeapProntos(); }
+    void inserirPronto(int processo) override;
+    int selecionarProximo() override;
+
+private:
+    HeapProntos prontos;
 };
 
 /**
@@ -117,6 +236,16 @@ class SRTF : public Escalonador {
 public:
     SRTF() : Escalonador("SRTF") {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<SRTF>(); }
+
+protected:
+    void limparProntos() override { prontos = HeapProntos(); }
+    void inserirPronto(int processo) override;
+    int selecionarProximo() override;
+    bool preemptivo() const override { return true; }
+
+private:
+    HeapProntos prontos;
 };
 
 /**
@@ -126,6 +255,19 @@ class RoundRobin : public Escalonador {
 public:
     RoundRobin(int quantum = 2) : Escalonador("Round Robin", quantum) {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<RoundRobin>(quantum); }
+    std::vector<std::string> getParametros() const override { return {"quantum"}; }
+    bool setParametro(const std::string& nome, int valor) override;
+    bool usaQuantum() const override { return true; }
+
+protected:
+    void limparProntos() override { filaReady.clear(); }
+    void inserirPronto(int processo) override { filaReady.push_back(processo); }
+    int selecionarProximo() override;
+    int duracaoFatia(int processo) const override;
+
+private:
+    std::deque<int> filaReady;
 };
 
 /**
@@ -135,6 +277,15 @@ class Priority : public Escalonador {
 public:
     Priority() : Escalonador("Priority") {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<Priority>(); }
+
+protected:
+    void limparProntos() override { prontos = HeapProntos(); }
+    void inserirPronto(int processo) override;
+    int selecionarProximo() override;
+
+private:
+    HeapProntos prontos;
 };
 
 /**
@@ -144,6 +295,16 @@ class PriorityPreemptivo : public Escalonador {
 public:
     PriorityPreemptivo() : Escalonador("Priority Preemptivo") {}
     Estatisticas executarSimulacao() override;
+    std::unique_ptr<Escalonador> clonar() const override { return std::make_unique<PriorityPreemptivo>(); }
+
+protected:
+    void limparProntos() override { prontos = HeapProntos(); }
+    void inserirPronto(int processo) override;
+    int selecionarProximo() override;
+    bool preemptivo() const override { return true; }
+
+private:
+    HeapProntos prontos;
 };
 
 #endif // ESCALONADOR_H
\ No newline at end of file
@@ -5,6 +5,38 @@
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <ostream>
+#include <functional>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Formatos de saída do modo em lote
+ */
+enum class FormatoSaida {
+    CSV,    // Uma linha por algoritmo, com cabeçalho
+    JSON,   // Um objeto JSON por linha (JSON Lines)
+    Tabela  // Tabela alinhada para leitura no terminal
+};
+
+/**
+ * @brief Faixa de valores de um parâmetro na varredura (inicio..fim, inclusive)
+ */
+struct FaixaParametro {
+    std::string nome;
+    int inicio;
+    int fim;
+    int passo;
+};
+
+/**
+ * @brief Resultado de uma execução: algoritmo, valores dos parâmetros e estatísticas
+ */
+struct LinhaResultado {
+    std::string algoritmo;
+    std::vector<std::string> valores;  // Um por parâmetro; vazio se não se aplica
+    Estatisticas stats;
+};
 
 /**
  * @brief Classe principal para gerenciar simulações de escalonamento
@@ -12,7 +44,8 @@
 class Simulador {
 private:
     std::vector<std::unique_ptr<Escalonador>> escalonadores;
-    std::vector<Processo> processosBase;
+    std::shared_ptr<const CargaTrabalho> carga;  // Carga única, compartilhada pelos escalonadores
+    bool verboso; // Mensagens de carga e rastro das simulações
 
 public:
     /**
@@ -32,6 +65,12 @@ public:
      */
     bool carregarProcessosArquivo(const std::string& nomeArquivo);
 
+    /**
+     * @brief Grava os processos carregados no formato binário (TraceBinario)
+     * @return true se gravou com sucesso, false caso contrário
+     */
+    bool salvarTraceBinario(const std::string& nomeArquivo) const;
+
     /**
      * @brief Adiciona processo manualmente
      */
@@ -47,6 +86,41 @@ public:
      */
     void executarTodosAlgoritmos();
 
+    /**
+     * @brief Executa todos os algoritmos em paralelo, sem pausas
+     *
+     * Cada escalonador roda em uma thread do pool, sem o rastro passo a
+     * passo; os resultados são exibidos na ordem de cadastro.
+     */
+    void executarTodosAlgoritmosParalelo();
+
+    /**
+     * @brief Executa os algoritmos sem interação e grava as estatísticas
+     * @param saida Destino das linhas de resultado
+     * @param formato CSV ou JSON Lines
+     * @param filtro Executa apenas algoritmos cujo nome contém o filtro (vazio = todos)
+     * @return false se nenhum algoritmo corresponde ao filtro
+     */
+    bool executarLote(std::ostream& saida, FormatoSaida formato, const std::string& filtro = "");
+
+    /**
+     * @brief Varre a grade de parâmetros sobre a carga compartilhada
+     *
+     * Cada ponto da grade (produto cartesiano das faixas) é simulado em um
+     * clone do escalonador, no pool de threads; as linhas saem na ordem da
+     * grade. No formato Tabela, também exibe o melhor ponto por métrica.
+     * @param faixas Parâmetros a variar (todos devem existir no algoritmo)
+     * @param filtro Considera apenas algoritmos cujo nome contém o filtro
+     * @return false se nenhum algoritmo aceita os parâmetros ou há valor inválido
+     */
+    bool executarVarredura(const std::vector<FaixaParametro>& faixas, std::ostream& saida,
+                           FormatoSaida formato, const std::string& filtro = "");
+
+    /**
+     * @brief Liga ou desliga as mensagens no console (carga e rastro)
+     */
+    void setVerboso(bool v);
+
     /**
      * @brief Executa um algoritmo específico
      */
@@ -74,7 +148,32 @@ public:
 
 private:
     /**
-     * @brief Distribui os processos para todos os escalonadores
+     * @brief Conclui a carga: publica a tabela lida (ou o exemplo) e distribui
+     */
+    void concluirCarga(TabelaProcessos tabela);
+
+    /**
+     * @brief Exibe a tabela comparativa dos resultados
+     */
+    void exibirComparacao(const std::vector<std::pair<std::string, Estatisticas>>& resultados) const;
+
+    /**
+     * @brief Grava linhas de resultado em CSV, JSON Lines ou tabela
+     * @param parametros Nomes das colunas de parâmetros, na ordem de LinhaResultado::valores
+     */
+    static void escreverResultados(std::ostream& saida, FormatoSaida formato,
+                                   const std::vector<std::string>& parametros,
+                                   const std::vector<LinhaResultado>& linhas);
+
+    /**
+     * @brief Executa tarefas independentes em um pool de threads
+     * @param totalTarefas Número de tarefas (índices de 0 a totalTarefas - 1)
+     * @param tarefa Função chamada com o índice de cada tarefa
+     */
+    static void executarEmParalelo(size_t totalTarefas, const std::function<void(size_t)>& tarefa);
+
+    /**
+     * @brief Entrega a carga compartilhada a todos os escalonadores
      */
     void distribuirProcessos();
 
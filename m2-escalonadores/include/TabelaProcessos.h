@@ -0,0 +1,71 @@
+#ifndef TABELA_PROCESSOS_H
+#define TABELA_PROCESSOS_H
+
+#include "Processo.h"
+#include <vector>
+#include <string>
+
+/**
+ * @brief Tabela de processos em estrutura de arrays (SoA)
+ *
+ * Cada atributo de entrada fica em um vetor próprio, indexado pela posição
+ * do processo, para que os laços da simulação percorram apenas os campos
+ * que usam. Os nomes ficam à parte, concatenados em uma tabela de texto.
+ */
+class TabelaProcessos {
+private:
+    std::vector<int> pids;
+    std::vector<int> temposChegada;
+    std::vector<int> temposCPU;
+    std::vector<int> prioridades;
+    std::vector<size_t> inicioNomes;  // Posição de cada nome em nomes (+1 sentinela)
+    std::string nomes;                // Nomes concatenados
+
+public:
+    /**
+     * @brief Construtor
+     */
+    TabelaProcessos();
+
+    /**
+     * @brief Adiciona um processo ao final da tabela
+     */
+    void adicionar(int pid, const std::string& nome, int tempoChegada, int tempoCPU, int prioridade);
+    void adicionar(int pid, const char* nome, size_t tamanhoNome,
+                   int tempoChegada, int tempoCPU, int prioridade);
+    void adicionar(const Processo& processo);
+
+    /**
+     * @brief Reserva espaço para n processos (e, opcionalmente, bytes de nomes)
+     */
+    void reservar(size_t n, size_t bytesNomes = 0);
+
+    /**
+     * @brief Remove todos os processos
+     */
+    void limpar();
+
+    size_t tamanho() const { return pids.size(); }
+    bool vazia() const { return pids.empty(); }
+
+    // Getters por índice
+    int getPid(size_t i) const { return pids[i]; }
+    int getTempoChegada(size_t i) const { return temposChegada[i]; }
+    int getTempoCPU(size_t i) const { return temposCPU[i]; }
+    int getPrioridade(size_t i) const { return prioridades[i]; }
+    std::string getNome(size_t i) const {
+        return nomes.substr(inicioNomes[i], inicioNomes[i + 1] - inicioNomes[i]);
+    }
+
+    /**
+     * @brief Coluna de tempos de CPU (usada para reiniciar o tempo restante)
+     */
+    const std::vector<int>& getTemposCPU() const { return temposCPU; }
+
+    /**
+     * @brief Monta um objeto Processo com os dados de entrada do índice i
+     */
+    Processo processo(size_t i) const;
+};
+
+#endif // TABELA_PROCESSOS_H
@@ -0,0 +1,63 @@
+#ifndef TRACE_BINARIO_H
+#define TRACE_BINARIO_H
+
+#include "TabelaProcessos.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Formato binário compacto para cargas de processos
+ *
+ * Layout do arquivo (inteiros na ordem de bytes da máquina):
+ *   - Cabecalho
+ *   - numProcessos registros de tamanho fixo (Registro)
+ *   - Tabela de nomes: nomes concatenados, sem terminador
+ */
+class TraceBinario {
+public:
+    static const char ASSINATURA[4];
+    static const uint32_t VERSAO = 1;
+
+    /**
+     * @brief Cabeçalho do arquivo
+     */
+    struct Cabecalho {
+        char assinatura[4];        // "ESCB"
+        uint32_t versao;
+        uint64_t numProcessos;
+        uint64_t tamanhoNomes;     // Bytes da tabela de nomes
+    };
+
+    /**
+     * @brief Registro de um processo
+     */
+    struct Registro {
+        int32_t pid;
+        int32_t tempoChegada;
+        int32_t tempoCPU;
+        int32_t prioridade;
+        uint32_t offsetNome;       // Posição do nome na tabela de nomes
+        uint32_t tamanhoNome;
+    };
+
+    /**
+     * @brief Verifica se o arquivo começa com a assinatura do formato binário
+     */
+    static bool ehTraceBinario(const std::string& nomeArquivo);
+
+    /**
+     * @brief Carrega processos mapeando o arquivo em memória (mmap)
+     * @param nomeArquivo Arquivo no formato binário
+     * @param tabela Tabela que recebe os processos (substituída)
+     * @return true se carregou com sucesso, false caso contrário
+     */
+    static bool carregar(const std::string& nomeArquivo, TabelaProcessos& tabela);
+
+    /**
+     * @brief Grava processos no formato binário
+     * @return true se gravou com sucesso, false caso contrário
+     */
+    static bool salvar(const std::string& nomeArquivo, const TabelaProcessos& tabela);
+};
+
+#endif // TRACE_BINARIO_H
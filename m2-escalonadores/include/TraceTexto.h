@@ -0,0 +1,29 @@
+#ifndef TRACE_TEXTO_H
+#define TRACE_TEXTO_H
+
+#include "TabelaProcessos.h"
+#include <string>
+
+/**
+ * @brief Leitor rápido do formato texto de processos
+ *
+ * Formato por linha: PID Nome TempoChegada TempoCPU [Prioridade]
+ * A primeira linha é tratada como cabeçalho se contiver letras; linhas
+ * vazias e iniciadas por '#' são ignoradas. O arquivo é lido de uma vez
+ * e analisado sem iostreams.
+ */
+class TraceTexto {
+public:
+    /**
+     * @brief Carrega processos de um arquivo texto
+     * @param nomeArquivo Arquivo no formato texto
+     * @param tabela Tabela que recebe os processos (substituída)
+     * @return true se o arquivo foi lido, false se não pôde ser aberto
+     *
+     * Linhas inválidas são reportadas em std::cerr com o número da linha
+     * e ignoradas.
+     */
+    static bool carregar(const std::string& nomeArquivo, TabelaProcessos& tabela);
+};
+
+#endif // TRACE_TEXTO_H
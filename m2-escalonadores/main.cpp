@@ -1,7 +1,168 @@
 #include "include/Simulador.h"
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Exibe as opções de linha de comando
+ */
+void exibirUso(const char* programa) {
+    std::cout << "Uso: " << programa << " [arquivo] [algoritmo] [opções]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Sem argumentos, abre o menu interativo." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opções:" << std::endl;
+    std::cout << "  --lote            Executa sem pausas nem rastro e grava as estatísticas" << std::endl;
+    std::cout << "  --varrer P=I:F[:S] Varre o parâmetro P de I a F com passo S (ex.: quantum=1:20)" << std::endl;
+    std::cout << "                    Pode ser repetida; os pontos formam uma grade" << std::endl;
+    std::cout << "  --formato FMT     csv, json ou tabela (padrão: csv no lote, tabela na varredura)" << std::endl;
+    std::cout << "  --saida ARQUIVO   Grava o resultado do lote em ARQUIVO (padrão: stdout)" << std::endl;
+    std::cout << "  --converter BIN   Converte o arquivo de processos para o formato binário BIN" << std::endl;
+    std::cout << "  --ajuda           Mostra esta ajuda" << std::endl;
+}
+
+/**
+ * @brief Lê uma faixa no formato nome=inicio:fim[:passo]
+ * @return false se o texto não está no formato esperado
+ */
+bool lerFaixa(const std::string& texto, FaixaParametro& faixa) {
+    size_t igual = texto.find('=');
+    if (igual == std::string::npos || igual == 0) return false;
+    faixa.nome = texto.substr(0, igual);
+    faixa.passo = 1;
+    
+    char resto = '\0';
+    int lidos = std::sscanf(texto.c_str() + igual + 1, "%d:%d:%d%c",
+                            &faixa.inicio, &faixa.fim, &faixa.passo, &resto);
+    if (lidos < 2 || lidos > 3) return false;
+    return faixa.passo >= 1 && faixa.inicio <= faixa.fim;
+}
+
+/**
+ * @brief Modo em lote: sem menu, pausas ou saída passo a passo
+ *
+ * Com faixas de parâmetros, executa a varredura em vez de uma linha por algoritmo.
+ */
+int executarModoLote(const std::vector<std::string>& posicionais, FormatoSaida formato,
+                     const std::string& arquivoSaida, const std::vector<FaixaParametro>& faixas) {
+    Simulador simulador;
+    simulador.setVerboso(false);
+    
+    if (!posicionais.empty() && !simulador.carregarProcessosArquivo(posicionais[0])) {
+        return 1;
+    }
+    std::string filtro = posicionais.size() > 1 ? posicionais[1] : "";
+    
+    std::ofstream arquivo;
+    if (!arquivoSaida.empty()) {
+        arquivo.open(arquivoSaida);
+        if (!arquivo.is_open()) {
+            std::cerr << "Erro ao criar arquivo de saída: " << arquivoSaida << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& saida = arquivoSaida.empty() ? std::cout : arquivo;
+    
+    if (!faixas.empty()) {
+        if (!simulador.executarVarredura(faixas, saida, formato, filtro)) {
+            std::cerr << "Nenhum algoritmo" << (filtro.empty() ? "" : " '" + filtro + "'")
+                      << " aceita os parâmetros e valores da varredura" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!simulador.executarLote(saida, formato, filtro)) {
+        std::cerr << "Algoritmo não encontrado: " << filtro << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Converte um arquivo de processos em texto para o formato binário
+ */
+int converterParaBinario(const std::vector<std::string>& posicionais, const std::string& arquivoBinario) {
+    if (posicionais.empty()) {
+        std::cerr << "Informe o arquivo de processos a converter" << std::endl;
+        return 1;
+    }
+    
+    Simulador simulador;
+    simulador.setVerboso(false);
+    if (!simulador.carregarProcessosArquivo(posicionais[0]) ||
+        !simulador.salvarTraceBinario(arquivoBinario)) {
+        return 1;
+    }
+    
+    std::cout << posicionais[0] << " -> " << arquivoBinario << std::endl;
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
+    // Separar opções dos argumentos posicionais (arquivo e algoritmo)
+    std::vector<std::string> posicionais;
+    bool modoLote = false;
+    FormatoSaida formato = FormatoSaida::CSV;
+    bool formatoDefinido = false;
+    std::vector<FaixaParametro> faixas;
+    std::string arquivoSaida;
+    std::string arquivoBinario;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--lote") {
+            modoLote = true;
+        } else if (arg == "--formato" && i + 1 < argc) {
+            std::string valor = argv[++i];
+            if (valor == "csv") {
+                formato = FormatoSaida::CSV;
+            } else if (valor == "json") {
+                formato = FormatoSaida::JSON;
+            } else if (valor == "tabela") {
+                formato = FormatoSaida::Tabela;
+            } else {
+                std::cerr << "Formato inválido: " << valor << " (use csv, json ou tabela)" << std::endl;
+                return 1;
+            }
+            formatoDefinido = true;
+        } else if (arg == "--varrer" && i + 1 < argc) {
+            FaixaParametro faixa;
+            if (!lerFaixa(argv[++i], faixa)) {
+                std::cerr << "Faixa inválida: " << argv[i] << " (use nome=inicio:fim[:passo])" << std::endl;
+                return 1;
+            }
+            faixas.push_back(faixa);
+        } else if (arg == "--saida" && i + 1 < argc) {
+            arquivoSaida = argv[++i];
+        } else if (arg == "--converter" && i + 1 < argc) {
+            arquivoBinario = argv[++i];
+        } else if (arg == "--ajuda" || arg == "-h") {
+            exibirUso(argv[0]);
+            return 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Opção inválida: " << arg << std::endl;
+            exibirUso(argv[0]);
+            return 1;
+        } else {
+            posicionais.push_back(arg);
+        }
+    }
+    
+    if (!arquivoBinario.empty()) {
+        return converterParaBinario(posicionais, arquivoBinario);
+    }
+    
+    if (!faixas.empty() && !formatoDefinido) {
+        formato = FormatoSaida::Tabela;
+    }
+    
+    if (modoLote || !faixas.empty()) {
+        return executarModoLote(posicionais, formato, arquivoSaida, faixas);
+    }
+    
     std::cout << "===============================================" << std::endl;
     std::cout << "    SIMULADOR DE ESCALONADORES DE CPU" << std::endl;
     std::cout << "      Trabalho de Sistemas Operacionais" << std::endl;
@@ -10,13 +171,13 @@ int main(int argc, char* argv[]) {
     Simulador simulador;
     
     // Verificar se foi passado arquivo como parâmetro
-    if (argc > 1) {
-        std::cout << "\nCarregando processos do arquivo: " << argv[1] << std::endl;
-        if (simulador.carregarProcessosArquivo(argv[1])) {
+    if (!posicionais.empty()) {
+        std::cout << "\nCarregando processos do arquivo: " << posicionais[0] << std::endl;
+        if (simulador.carregarProcessosArquivo(posicionais[0])) {
             // Se foi passado um segundo parâmetro, executar apenas esse algoritmo
-            if (argc > 2) {
-                std::cout << "\nExecutando algoritmo: " << argv[2] << std::endl;
-                simulador.executarAlgoritmo(argv[2]);
+            if (posicionais.size() > 1) {
+                std::cout << "\nExecutando algoritmo: " << posicionais[1] << std::endl;
+                simulador.executarAlgoritmo(posicionais[1]);
             } else {
                 // Executar todos os algoritmos
                 simulador.executarTodosAlgoritmos();
@@ -31,4 +192,4 @@ int main(int argc, char* argv[]) {
     }
     
     return 0;
-}
\ No newline at end of file
+}
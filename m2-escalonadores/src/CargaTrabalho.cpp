@@ -0,0 +1,21 @@
+#include "../include/CargaTrabalho.h"
+#include <algorithm>
+#include <utility>
+
+CargaTrabalho::CargaTrabalho(TabelaProcessos tabela)
+    : tabela(std::move(tabela)), tempoCPUTotal(0) {
+    const TabelaProcessos& t = this->tabela;
+    
+    for (size_t i = 0; i < t.tamanho(); ++i) {
+        tempoCPUTotal += t.getTempoCPU(i);
+        if (t.getTempoCPU(i) > 0) {
+            ordemChegada.push_back(static_cast<int>(i));
+        }
+    }
+    
+    // Índice de chegada: ordem estável mantém a posição na lista como desempate
+    std::stable_sort(ordemChegada.begin(), ordemChegada.end(),
+        [&t](int a, int b) {
+            return std::max(0, t.getTempoChegada(a)) < std::max(0, t.getTempoChegada(b));
+        });
+}
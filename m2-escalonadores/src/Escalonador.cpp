@@ -3,56 +3,88 @@
 #include <iomanip>
 #include <algorithm>
 #include <queue>
+#include <limits>
+#include <utility>
 
 Escalonador::Escalonador(const std::string& nome, int quantum)
-    : tempoAtual(0), quantum(quantum), nomeAlgoritmo(nome) {
+    : carga(std::make_shared<const CargaTrabalho>()),
+      cursorChegada(0), processosConcluidos(0), processosAExecutar(0),
+      tempoAtual(0), quantum(quantum), nomeAlgoritmo(nome), verboso(true) {
 }
 
-void Escalonador::adicionarProcesso(const Processo& processo) {
-    processos.push_back(processo);
-    processosOriginais.push_back(processo);
+void Escalonador::setCarga(std::shared_ptr<const CargaTrabalho> novaCarga) {
+    carga = novaCarga ? std::move(novaCarga) : std::make_shared<const CargaTrabalho>();
+    
+    // O estado da execução só é alocado na próxima simulação
+    tempoRestante = std::vector<int>();
+    tempoInicioExecucao = std::vector<int>();
+    tempoFinalizacao = std::vector<int>();
 }
 
 void Escalonador::reiniciarSimulacao() {
+    size_t n = tabela().tamanho();
     tempoAtual = 0;
-    processos = processosOriginais;
-    for (auto& p : processos) {
-        p.reiniciar();
+    processosConcluidos = 0;
+    processosAExecutar = static_cast<int>(carga->getOrdemChegada().size());
+    cursorChegada = 0;
+    
+    // Estado inicial: cópias contíguas de vetores de int
+    tempoRestante = tabela().getTemposCPU();
+    tempoInicioExecucao.assign(n, -1);
+    tempoFinalizacao.assign(n, -1);
+}
+
+Processo Escalonador::obterProcesso(size_t i) const {
+    Processo p = tabela().processo(i);
+    if (i >= tempoRestante.size()) return p;
+    
+    p.setTempoRestante(tempoRestante[i]);
+    if (tempoInicioExecucao[i] != -1) {
+        p.setTempoInicioExecucao(tempoInicioExecucao[i]);
+        p.setTempoResposta(tempoInicioExecucao[i] - tabela().getTempoChegada(i));
+        p.setJaExecutou(true);
+    }
+    if (tempoFinalizacao[i] != -1) {
+        p.setTempoFinalizacao(tempoFinalizacao[i]);
+        p.setTempoEspera(p.getTempoTurnaround() - p.getTempoCPU());
     }
+    return p;
 }
 
-std::vector<Processo*> Escalonador::obterProcessosChegando() {
-    std::vector<Processo*> chegando;
-    for (auto& p : processos) {
-        if (p.getTempoChegada() == tempoAtual && !p.terminou()) {
-            chegando.push_back(&p);
-        }
+bool Escalonador::admitirChegadas() {
+    bool admitiu = false;
+    const std::vector<int>& ordemChegada = carga->getOrdemChegada();
+    while (cursorChegada < ordemChegada.size() &&
+           tabela().getTempoChegada(ordemChegada[cursorChegada]) <= tempoAtual) {
+        inserirPronto(ordemChegada[cursorChegada]);
+        cursorChegada++;
+        admitiu = true;
     }
-    return chegando;
+    return admitiu;
 }
 
-bool Escalonador::todosProcessosTerminaram() const {
-    for (const auto& p : processos) {
-        if (!p.terminou()) return false;
+int Escalonador::proximaChegada() const {
+    const std::vector<int>& ordemChegada = carga->getOrdemChegada();
+    if (cursorChegada == ordemChegada.size()) {
+        return std::numeric_limits<int>::max();
     }
-    return true;
+    return std::max(0, tabela().getTempoChegada(ordemChegada[cursorChegada]));
 }
 
 Estatisticas Escalonador::calcularEstatisticas() const {
     Estatisticas stats;
     int totalProcessos = 0;
-    int somaEspera = 0, somaTurnaround = 0, somaResposta = 0;
+    long long somaEspera = 0, somaTurnaround = 0, somaResposta = 0;
     int tempoTotalExecucao = 0;
     
-    for (const auto& p : processos) {
-        if (p.getTempoFinalizacao() != -1) {
+    for (size_t i = 0; i < tempoFinalizacao.size(); ++i) {
+        if (tempoFinalizacao[i] != -1) {
+            int turnaround = tempoFinalizacao[i] - tabela().getTempoChegada(i);
             totalProcessos++;
-            somaEspera += p.getTempoEspera();
-            somaTurnaround += p.getTempoTurnaround();
-            if (p.getTempoResposta() != -1) {
-                somaResposta += p.getTempoResposta();
-            }
-            tempoTotalExecucao = std::max(tempoTotalExecucao, p.getTempoFinalizacao());
+            somaEspera += turnaround - tabela().getTempoCPU(i);
+            somaTurnaround += turnaround;
+            somaResposta += tempoInicioExecucao[i] - tabela().getTempoChegada(i);
+            tempoTotalExecucao = std::max(tempoTotalExecucao, tempoFinalizacao[i]);
         }
     }
     
@@ -63,11 +95,7 @@ Estatisticas Escalonador::calcularEstatisticas() const {
         stats.throughput = totalProcessos;
         
         // Calcular utilização da CPU
-        int tempoCPUTotal = 0;
-        for (const auto& p : processos) {
-            tempoCPUTotal += p.getTempoCPU();
-        }
-        stats.utilizacaoCPU = (static_cast<double>(tempoCPUTotal) / tempoTotalExecucao) * 100;
+        stats.utilizacaoCPU = (static_cast<double>(carga->getTempoCPUTotal()) / tempoTotalExecucao) * 100;
     }
     
     return stats;
@@ -91,8 +119,8 @@ void Escalonador::exibirResultado(const Estatisticas& stats) const {
     std::cout << std::string(112, '-') << std::endl;
     
     // Dados dos processos
-    for (const auto& p : processos) {
-        std::cout << p.toString() << std::endl;
+    for (size_t i = 0; i < tabela().tamanho(); ++i) {
+        std::cout << obterProcesso(i).toString() << std::endl;
     }
     
     std::cout << std::string(112, '-') << std::endl;
@@ -107,334 +135,176 @@ void Escalonador::exibirResultado(const Estatisticas& stats) const {
     std::cout << "Throughput: " << stats.throughput << " processos" << std::endl;
 }
 
-void Escalonador::exibirEstadoAtual(const Processo* processoAtual) const {
+void Escalonador::exibirEstadoAtual(int processoAtual) const {
+    if (!verboso) return;
+    
     std::cout << "Tempo " << tempoAtual << ": ";
-    if (processoAtual) {
-        std::cout << "Executando P" << processoAtual->getPid() 
-                  << " (restante: " << processoAtual->getTempoRestante() << ")";
+    if (processoAtual != -1) {
+        std::cout << "Executando P" << tabela().getPid(processoAtual)
+                  << " (restante: " << tempoRestante[processoAtual] << ")";
     } else {
         std::cout << "CPU ociosa";
     }
     std::cout << std::endl;
 }
 
-// ================================
-// IMPLEMENTAÇÃO DOS ALGORITMOS
-// ================================
-
-Estatisticas FCFS::executarSimulacao() {
+Estatisticas Escalonador::simularEventos() {
     reiniciarSimulacao();
-    std::queue<Processo*> filaReady;
+    limparProntos();
     
-    std::cout << "\n=== SIMULAÇÃO FCFS ===" << std::endl;
+    int atual = -1;
+    int inicioFatia = 0;
+    int fimFatia = 0;
     
-    while (!todosProcessosTerminaram()) {
-        // Adicionar processos que chegaram
-        auto chegando = obterProcessosChegando();
-        for (auto* p : chegando) {
-            filaReady.push(p);
-        }
-        
-        if (!filaReady.empty()) {
-            Processo* atual = filaReady.front();
-            
-            // Marcar início da execução se necessário
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar processo até terminar
-            while (!atual->terminou()) {
-                atual->executar();
-                tempoAtual++;
-                
-                // Adicionar processos que chegaram durante a execução
-                auto chegandoDurante = obterProcessosChegando();
-                for (auto* p : chegandoDurante) {
-                    filaReady.push(p);
-                }
-            }
-            
-            // Processo terminou
-            atual->setTempoFinalizacao(tempoAtual);
-            atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            filaReady.pop();
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
-        }
+    if (!todosProcessosTerminaram() && proximaChegada() > tempoAtual) {
+        exibirEstadoAtual(-1);
     }
     
-    return calcularEstatisticas();
-}
-
-Estatisticas SJF::executarSimulacao() {
-    reiniciarSimulacao();
-    
-    std::cout << "\n=== SIMULAÇÃO SJF ===" << std::endl;
-    
     while (!todosProcessosTerminaram()) {
-        // Encontrar processos disponíveis
-        std::vector<Processo*> disponiveis;
-        for (auto& p : processos) {
-            if (p.getTempoChegada() <= tempoAtual && !p.terminou()) {
-                disponiveis.push_back(&p);
+        // Avançar até o próximo ponto de decisão
+        tempoAtual = atual != -1 ? std::min(fimFatia, proximaChegada()) : proximaChegada();
+        
+        bool houveChegada = admitirChegadas();
+        
+        // Encerrar a fatia atual por conclusão, quantum ou preempção
+        if (atual != -1 && (tempoAtual == fimFatia || (houveChegada && preemptivo()))) {
+            tempoRestante[atual] -= tempoAtual - inicioFatia;
+            if (tempoRestante[atual] == 0) {
+                tempoFinalizacao[atual] = tempoAtual;
+                processosConcluidos++;
+            } else {
+                inserirPronto(atual);
             }
+            atual = -1;
         }
         
-        if (!disponiveis.empty()) {
-            // Selecionar o processo com menor tempo de CPU
-            auto menorTempo = std::min_element(disponiveis.begin(), disponiveis.end(),
-                [](const Processo* a, const Processo* b) {
-                    return a->getTempoCPU() < b->getTempoCPU();
-                });
-            
-            Processo* atual = *menorTempo;
-            
-            // Marcar início da execução
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar processo até terminar
-            while (!atual->terminou()) {
-                atual->executar();
-                tempoAtual++;
-            }
-            
-            // Processo terminou
-            atual->setTempoFinalizacao(tempoAtual);
-            atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
+        if (atual != -1 || todosProcessosTerminaram()) continue;
+        
+        atual = selecionarProximo();
+        if (atual == -1) {
+            exibirEstadoAtual(-1);
+            continue;
+        }
+        
+        // Marcar início da execução se necessário
+        if (tempoInicioExecucao[atual] == -1) {
+            tempoInicioExecucao[atual] = tempoAtual;
         }
+        
+        exibirEstadoAtual(atual);
+        
+        inicioFatia = tempoAtual;
+        fimFatia = tempoAtual + duracaoFatia(atual);
     }
     
     return calcularEstatisticas();
 }
 
+// ================================
+// IMPLEMENTAÇÃO DOS ALGORITMOS
+// ================================
+
+Estatisticas FCFS::executarSimulacao() {
+    if (verboso) std::cout << "\n=== SIMULAÇÃO FCFS ===" << std::endl;
+    return simularEventos();
+}
+
+int FCFS::selecionarProximo() {
+    if (filaReady.empty()) return -1;
+    int proximo = filaReady.front();
+    filaReady.pop_front();
+    return proximo;
+}
+
+Estatisticas SJF::executarSimulacao() {
+    if (verboso) std::cout << "\n=== SIMULAÇÃO SJF ===" << std::endl;
+    return simularEventos();
+}
+
+void SJF::inserirPronto(int processo) {
+    // Ordenado pelo menor tempo de CPU
+    prontos.push(EntradaPronto{tabela().getTempoCPU(processo), 0, processo});
+}
+
+int SJF::selecionarProximo() {
+    if (prontos.empty()) return -1;
+    int proximo = prontos.top().indice;
+    prontos.pop();
+    return proximo;
+}
+
 Estatisticas SRTF::executarSimulacao() {
-    reiniciarSimulacao();
-    
-    std::cout << "\n=== SIMULAÇÃO SRTF ===" << std::endl;
-    
-    while (!todosProcessosTerminaram()) {
-        // Encontrar processos disponíveis
-        std::vector<Processo*> disponiveis;
-        for (auto& p : processos) {
-            if (p.getTempoChegada() <= tempoAtual && !p.terminou()) {
-                disponiveis.push_back(&p);
-            }
-        }
-        
-        if (!disponiveis.empty()) {
-            // Selecionar o processo com menor tempo restante
-            auto menorRestante = std::min_element(disponiveis.begin(), disponiveis.end(),
-                [](const Processo* a, const Processo* b) {
-                    return a->getTempoRestante() < b->getTempoRestante();
-                });
-            
-            Processo* atual = *menorRestante;
-            
-            // Marcar início da execução se necessário
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar por uma unidade de tempo
-            bool terminou = atual->executar();
-            tempoAtual++;
-            
-            if (terminou) {
-                atual->setTempoFinalizacao(tempoAtual);
-                atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            }
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
-        }
-    }
-    
-    return calcularEstatisticas();
+    if (verboso) std::cout << "\n=== SIMULAÇÃO SRTF ===" << std::endl;
+    return simularEventos();
+}
+
+void SRTF::inserirPronto(int processo) {
+    // Ordenado pelo menor tempo restante; só muda enquanto executa, fora do heap
+    prontos.push(EntradaPronto{tempoRestante[processo], 0, processo});
+}
+
+int SRTF::selecionarProximo() {
+    if (prontos.empty()) return -1;
+    int proximo = prontos.top().indice;
+    prontos.pop();
+    return proximo;
 }
 
 Estatisticas RoundRobin::executarSimulacao() {
-    reiniciarSimulacao();
-    std::queue<Processo*> filaReady;
-    int quantumAtual = 0;
-    
-    std::cout << "\n=== SIMULAÇÃO ROUND ROBIN (Quantum = " << quantum << ") ===" << std::endl;
-    
-    while (!todosProcessosTerminaram()) {
-        // Adicionar processos que chegaram
-        auto chegando = obterProcessosChegando();
-        for (auto* p : chegando) {
-            filaReady.push(p);
-        }
-        
-        if (!filaReady.empty()) {
-            Processo* atual = filaReady.front();
-            filaReady.pop();
-            
-            // Marcar início da execução se necessário
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar por quantum ou até terminar
-            quantumAtual = 0;
-            while (quantumAtual < quantum && !atual->terminou()) {
-                atual->executar();
-                tempoAtual++;
-                quantumAtual++;
-                
-                // Adicionar processos que chegaram durante a execução
-                auto chegandoDurante = obterProcessosChegando();
-                for (auto* p : chegandoDurante) {
-                    filaReady.push(p);
-                }
-            }
-            
-            if (atual->terminou()) {
-                atual->setTempoFinalizacao(tempoAtual);
-                atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            } else {
-                // Processo não terminou, volta para o final da fila
-                filaReady.push(atual);
-            }
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
-        }
-    }
-    
-    return calcularEstatisticas();
+    if (verboso) std::cout << "\n=== SIMULAÇÃO ROUND ROBIN (Quantum = " << quantum << ") ===" << std::endl;
+    return simularEventos();
+}
+
+int RoundRobin::selecionarProximo() {
+    if (filaReady.empty()) return -1;
+    int proximo = filaReady.front();
+    filaReady.pop_front();
+    return proximo;
+}
+
+bool RoundRobin::setParametro(const std::string& nome, int valor) {
+    if (nome != "quantum" || valor < 1) return false;
+    quantum = valor;
+    return true;
+}
+
+int RoundRobin::duracaoFatia(int processo) const {
+    // Executar por quantum ou até terminar
+    return std::min(std::max(quantum, 1), tempoRestante[processo]);
 }
 
 Estatisticas Priority::executarSimulacao() {
-    reiniciarSimulacao();
-    
-    std::cout << "\n=== SIMULAÇÃO PRIORITY ===" << std::endl;
-    
-    while (!todosProcessosTerminaram()) {
-        // Encontrar processos disponíveis
-        std::vector<Processo*> disponiveis;
-        for (auto& p : processos) {
-            if (p.getTempoChegada() <= tempoAtual && !p.terminou()) {
-                disponiveis.push_back(&p);
-            }
-        }
-        
-        if (!disponiveis.empty()) {
-            // Selecionar o processo com maior prioridade (menor número)
-            auto maiorPrioridade = std::min_element(disponiveis.begin(), disponiveis.end(),
-                [](const Processo* a, const Processo* b) {
-                    if (a->getPrioridade() == b->getPrioridade()) {
-                        return a->getTempoChegada() < b->getTempoChegada(); // FCFS como desempate
-                    }
-                    return a->getPrioridade() < b->getPrioridade();
-                });
-            
-            Processo* atual = *maiorPrioridade;
-            
-            // Marcar início da execução
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar processo até terminar
-            while (!atual->terminou()) {
-                atual->executar();
-                tempoAtual++;
-            }
-            
-            // Processo terminou
-            atual->setTempoFinalizacao(tempoAtual);
-            atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
-        }
-    }
-    
-    return calcularEstatisticas();
+    if (verboso) std::cout << "\n=== SIMULAÇÃO PRIORITY ===" << std::endl;
+    return simularEventos();
+}
+
+void Priority::inserirPronto(int processo) {
+    // Maior prioridade (menor número) primeiro, FCFS como desempate
+    prontos.push(EntradaPronto{tabela().getPrioridade(processo), tabela().getTempoChegada(processo),
+                               processo});
+}
+
+int Priority::selecionarProximo() {
+    if (prontos.empty()) return -1;
+    int proximo = prontos.top().indice;
+    prontos.pop();
+    return proximo;
 }
 
 Estatisticas PriorityPreemptivo::executarSimulacao() {
-    reiniciarSimulacao();
-    
-    std::cout << "\n=== SIMULAÇÃO PRIORITY PREEMPTIVO ===" << std::endl;
-    
-    while (!todosProcessosTerminaram()) {
-        // Encontrar processos disponíveis
-        std::vector<Processo*> disponiveis;
-        for (auto& p : processos) {
-            if (p.getTempoChegada() <= tempoAtual && !p.terminou()) {
-                disponiveis.push_back(&p);
-            }
-        }
-        
-        if (!disponiveis.empty()) {
-            // Selecionar o processo com maior prioridade (menor número)
-            auto maiorPrioridade = std::min_element(disponiveis.begin(), disponiveis.end(),
-                [](const Processo* a, const Processo* b) {
-                    if (a->getPrioridade() == b->getPrioridade()) {
-                        return a->getTempoChegada() < b->getTempoChegada();
-                    }
-                    return a->getPrioridade() < b->getPrioridade();
-                });
-            
-            Processo* atual = *maiorPrioridade;
-            
-            // Marcar início da execução se necessário
-            if (!atual->getJaExecutou()) {
-                atual->setTempoInicioExecucao(tempoAtual);
-                atual->setTempoResposta(tempoAtual - atual->getTempoChegada());
-                atual->setJaExecutou(true);
-            }
-            
-            exibirEstadoAtual(atual);
-            
-            // Executar por uma unidade de tempo
-            bool terminou = atual->executar();
-            tempoAtual++;
-            
-            if (terminou) {
-                atual->setTempoFinalizacao(tempoAtual);
-                atual->setTempoEspera(atual->getTempoTurnaround() - atual->getTempoCPU());
-            }
-            
-        } else {
-            exibirEstadoAtual(nullptr);
-            tempoAtual++;
-        }
-    }
-    
-    return calcularEstatisticas();
-}
\ No newline at end of file
+    if (verboso) std::cout << "\n=== SIMULAÇÃO PRIORITY PREEMPTIVO ===" << std::endl;
+    return simularEventos();
+}
+
+void PriorityPreemptivo::inserirPronto(int processo) {
+    // Maior prioridade (menor número) primeiro, FCFS como desempate
+    prontos.push(EntradaPronto{tabela().getPrioridade(processo), tabela().getTempoChegada(processo),
+                               processo});
+}
+
+int PriorityPreemptivo::selecionarProximo() {
+    if (prontos.empty()) return -1;
+    int proximo = prontos.top().indice;
+    prontos.pop();
+    return proximo;
+}
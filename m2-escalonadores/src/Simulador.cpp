@@ -1,11 +1,16 @@
 #include "../include/Simulador.h"
+#include "../include/TraceBinario.h"
+#include "../include/TraceTexto.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <utility>
 
-Simulador::Simulador() {
+Simulador::Simulador() : carga(std::make_shared<const CargaTrabalho>()), verboso(true) {
     // Inicializar com os algoritmos principais
     escalonadores.push_back(std::make_unique<FCFS>());
     escalonadores.push_back(std::make_unique<SJF>());
@@ -17,84 +22,79 @@ Simulador::Simulador() {
 }
 
 bool Simulador::carregarProcessosArquivo(const std::string& nomeArquivo) {
-    std::ifstream arquivo(nomeArquivo);
-    if (!arquivo.is_open()) {
-        std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
-        return false;
-    }
+    TabelaProcessos tabela;
     
-    processosBase.clear();
-    std::string linha;
-    int numeroLinha = 0;
-    
-    // Pular cabeçalho se existir
-    if (std::getline(arquivo, linha)) {
-        numeroLinha++;
-        // Se a primeira linha contém letras, é provável que seja cabeçalho
-        if (linha.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz") != std::string::npos) {
-            // É cabeçalho, continue lendo
-        } else {
-            // Não é cabeçalho, processar esta linha
-            arquivo.seekg(0); // Voltar ao início
-            numeroLinha = 0;
+    // Formato binário: carga direta por mmap, sem parsing por linha
+    if (TraceBinario::ehTraceBinario(nomeArquivo)) {
+        if (!TraceBinario::carregar(nomeArquivo, tabela)) {
+            return false;
+        }
+    } else {
+        if (!TraceTexto::carregar(nomeArquivo, tabela)) {
+            return false;
         }
-    }
-    
-    while (std::getline(arquivo, linha)) {
-        numeroLinha++;
-        if (linha.empty() || linha[0] == '#') continue; // Pular linhas vazias e comentários
-        
-        std::istringstream iss(linha);
-        int pid, tempoChegada, tempoCPU, prioridade = 0;
-        std::string nome;
         
-        // Formato esperado: PID Nome TempoChegada TempoCPU [Prioridade]
-        if (iss >> pid >> nome >> tempoChegada >> tempoCPU) {
-            iss >> prioridade; // Prioridade é opcional
-            
-            processosBase.emplace_back(pid, nome, tempoChegada, tempoCPU, prioridade);
-            std::cout << "Processo carregado: P" << pid << " (" << nome << ")" << std::endl;
-        } else {
-            std::cerr << "Erro na linha " << numeroLinha << ": " << linha << std::endl;
+        if (verboso) {
+            for (size_t i = 0; i < tabela.tamanho(); ++i) {
+                std::cout << "Processo carregado: P" << tabela.getPid(i)
+                          << " (" << tabela.getNome(i) << ")" << std::endl;
+            }
         }
     }
     
-    arquivo.close();
-    
-    if (processosBase.empty()) {
-        std::cout << "Nenhum processo foi carregado. Criando exemplo..." << std::endl;
+    concluirCarga(std::move(tabela));
+    return true;
+}
+
+bool Simulador::salvarTraceBinario(const std::string& nomeArquivo) const {
+    return TraceBinario::salvar(nomeArquivo, carga->getTabela());
+}
+
+void Simulador::concluirCarga(TabelaProcessos tabela) {
+    if (tabela.vazia()) {
+        if (verboso) {
+            std::cout << "Nenhum processo foi carregado. Criando exemplo..." << std::endl;
+        }
         criarExemploProcessos();
     } else {
-        std::cout << "Carregados " << processosBase.size() << " processos." << std::endl;
-        distribuirProcessos();
+        if (verboso) {
+            std::cout << "Carregados " << tabela.tamanho() << " processos." << std::endl;
+        }
+        carga = std::make_shared<const CargaTrabalho>(std::move(tabela));
     }
-    
-    return true;
+    distribuirProcessos();
 }
 
 void Simulador::adicionarProcesso(const Processo& processo) {
-    processosBase.push_back(processo);
+    // A carga é imutável: monta uma nova a partir de uma cópia da tabela
+    TabelaProcessos tabela = carga->getTabela();
+    tabela.adicionar(processo);
+    carga = std::make_shared<const CargaTrabalho>(std::move(tabela));
     distribuirProcessos();
 }
 
+void Simulador::setVerboso(bool v) {
+    verboso = v;
+    for (auto& escalonador : escalonadores) {
+        escalonador->setVerboso(v);
+    }
+}
+
 void Simulador::adicionarEscalonador(std::unique_ptr<Escalonador> escalonador) {
+    escalonador->setVerboso(verboso);
+    escalonador->setCarga(carga);
     escalonadores.push_back(std::move(escalonador));
-    if (!processosBase.empty()) {
-        distribuirProcessos();
-    }
 }
 
 void Simulador::distribuirProcessos() {
+    // Todos compartilham a mesma carga; cada um guarda só o próprio estado
     for (auto& escalonador : escalonadores) {
-        escalonador->reiniciarSimulacao();
-        for (const auto& processo : processosBase) {
-            escalonador->adicionarProcesso(processo);
-        }
+        escalonador->setCarga(carga);
     }
 }
 
 void Simulador::executarTodosAlgoritmos() {
-    if (processosBase.empty()) {
+    if (carga->vazia()) {
         std::cout << "Nenhum processo carregado! Criando exemplo..." << std::endl;
         criarExemploProcessos();
         distribuirProcessos();
@@ -116,7 +116,231 @@ void Simulador::executarTodosAlgoritmos() {
         std::cin.get();
     }
     
-    // Exibir comparação
+    exibirComparacao(resultados);
+}
+
+void Simulador::executarTodosAlgoritmosParalelo() {
+    if (carga->vazia()) {
+        std::cout << "Nenhum processo carregado! Criando exemplo..." << std::endl;
+        criarExemploProcessos();
+        distribuirProcessos();
+    }
+    
+    std::cout << "\n" << std::string(80, '#') << std::endl;
+    std::cout << "EXECUTANDO TODOS OS ALGORITMOS EM PARALELO" << std::endl;
+    std::cout << std::string(80, '#') << std::endl;
+    
+    // Cada tarefa escreve apenas na sua posição, mantendo a ordem de cadastro
+    std::vector<Estatisticas> estatisticas(escalonadores.size());
+    executarEmParalelo(escalonadores.size(), [this, &estatisticas](size_t i) {
+        bool verbosoAnterior = escalonadores[i]->getVerboso();
+        escalonadores[i]->setVerboso(false);
+        estatisticas[i] = escalonadores[i]->executarSimulacao();
+        escalonadores[i]->setVerboso(verbosoAnterior);
+    });
+    
+    std::vector<std::pair<std::string, Estatisticas>> resultados;
+    for (size_t i = 0; i < escalonadores.size(); ++i) {
+        escalonadores[i]->exibirResultado(estatisticas[i]);
+        resultados.push_back({escalonadores[i]->getNomeAlgoritmo(), estatisticas[i]});
+    }
+    
+    exibirComparacao(resultados);
+}
+
+bool Simulador::executarLote(std::ostream& saida, FormatoSaida formato, const std::string& filtro) {
+    if (carga->vazia()) {
+        criarExemploProcessos();
+        distribuirProcessos();
+    }
+    
+    std::vector<Escalonador*> selecionados;
+    for (auto& escalonador : escalonadores) {
+        if (escalonador->getNomeAlgoritmo().find(filtro) != std::string::npos) {
+            selecionados.push_back(escalonador.get());
+        }
+    }
+    if (selecionados.empty()) return false;
+    
+    std::vector<Estatisticas> estatisticas(selecionados.size());
+    executarEmParalelo(selecionados.size(), [&selecionados, &estatisticas](size_t i) {
+        bool verbosoAnterior = selecionados[i]->getVerboso();
+        selecionados[i]->setVerboso(false);
+        estatisticas[i] = selecionados[i]->executarSimulacao();
+        selecionados[i]->setVerboso(verbosoAnterior);
+    });
+    
+    std::vector<LinhaResultado> linhas(selecionados.size());
+    for (size_t i = 0; i < selecionados.size(); ++i) {
+        linhas[i].algoritmo = selecionados[i]->getNomeAlgoritmo();
+        linhas[i].valores.push_back(selecionados[i]->usaQuantum() ?
+                                    std::to_string(selecionados[i]->getQuantum()) : "");
+        linhas[i].stats = estatisticas[i];
+    }
+    
+    escreverResultados(saida, formato, {"quantum"}, linhas);
+    return true;
+}
+
+bool Simulador::executarVarredura(const std::vector<FaixaParametro>& faixas, std::ostream& saida,
+                                  FormatoSaida formato, const std::string& filtro) {
+    if (carga->vazia()) {
+        criarExemploProcessos();
+        distribuirProcessos();
+    }
+    
+    // Um protótipo por algoritmo que possui todos os parâmetros varridos
+    std::vector<const Escalonador*> prototipos;
+    for (const auto& escalonador : escalonadores) {
+        const std::string& nome = escalonador->getNomeAlgoritmo();
+        if (nome.find(filtro) == std::string::npos) continue;
+        
+        std::vector<std::string> aceitos = escalonador->getParametros();
+        bool aceitaTodos = std::all_of(faixas.begin(), faixas.end(), [&aceitos](const FaixaParametro& f) {
+            return std::find(aceitos.begin(), aceitos.end(), f.nome) != aceitos.end();
+        });
+        bool repetido = std::any_of(prototipos.begin(), prototipos.end(), [&nome](const Escalonador* p) {
+            return p->getNomeAlgoritmo() == nome;
+        });
+        if (aceitaTodos && !repetido) prototipos.push_back(escalonador.get());
+    }
+    if (prototipos.empty()) return false;
+    
+    // Grade: produto cartesiano das faixas, na ordem em que foram dadas
+    std::vector<std::vector<int>> pontos(1);
+    for (const auto& faixa : faixas) {
+        if (faixa.passo < 1 || faixa.inicio > faixa.fim) return false;
+        
+        std::vector<std::vector<int>> expandidos;
+        for (const auto& ponto : pontos) {
+            for (long long v = faixa.inicio; v <= faixa.fim; v += faixa.passo) {
+                expandidos.push_back(ponto);
+                expandidos.back().push_back(static_cast<int>(v));
+            }
+        }
+        pontos.swap(expandidos);
+    }
+    
+    // Valida os valores antes de simular (ex.: quantum >= 1)
+    for (const Escalonador* prototipo : prototipos) {
+        std::unique_ptr<Escalonador> teste = prototipo->clonar();
+        for (size_t k = 0; k < faixas.size(); ++k) {
+            if (!teste->setParametro(faixas[k].nome, faixas[k].inicio)) return false;
+        }
+    }
+    
+    // Cada tarefa simula um clone; só as estatísticas sobrevivem à tarefa
+    std::vector<LinhaResultado> linhas(prototipos.size() * pontos.size());
+    executarEmParalelo(linhas.size(), [&](size_t t) {
+        const std::vector<int>& ponto = pontos[t % pontos.size()];
+        std::unique_ptr<Escalonador> escalonador = prototipos[t / pontos.size()]->clonar();
+        escalonador->setVerboso(false);
+        escalonador->setCarga(carga);
+        
+        LinhaResultado& linha = linhas[t];
+        linha.algoritmo = escalonador->getNomeAlgoritmo();
+        for (size_t k = 0; k < faixas.size(); ++k) {
+            escalonador->setParametro(faixas[k].nome, ponto[k]);
+            linha.valores.push_back(std::to_string(ponto[k]));
+        }
+        linha.stats = escalonador->executarSimulacao();
+    });
+    
+    std::vector<std::string> parametros;
+    for (const auto& faixa : faixas) parametros.push_back(faixa.nome);
+    escreverResultados(saida, formato, parametros, linhas);
+    
+    if (formato == FormatoSaida::Tabela) {
+        // Melhor ponto por métrica (menor valor; empate fica com o primeiro da grade)
+        typedef double Estatisticas::*Metrica;
+        const std::pair<const char*, Metrica> metricas[] = {
+            {"Menor espera média", &Estatisticas::tempoMedioEspera},
+            {"Menor turnaround médio", &Estatisticas::tempoMedioTurnaround},
+            {"Menor resposta média", &Estatisticas::tempoMedioResposta},
+        };
+        
+        saida << "\nMELHOR PONTO POR MÉTRICA:" << std::endl;
+        for (const auto& metrica : metricas) {
+            Metrica campo = metrica.second;
+            auto melhor = std::min_element(linhas.begin(), linhas.end(),
+                [campo](const LinhaResultado& a, const LinhaResultado& b) {
+                    return a.stats.*campo < b.stats.*campo;
+                });
+            saida << std::left << std::setw(25) << metrica.first << std::right
+                  << melhor->algoritmo;
+            for (size_t k = 0; k < parametros.size(); ++k) {
+                saida << ' ' << parametros[k] << '=' << melhor->valores[k];
+            }
+            saida << " (" << melhor->stats.*campo << ")" << std::endl;
+        }
+    }
+    
+    return true;
+}
+
+void Simulador::escreverResultados(std::ostream& saida, FormatoSaida formato,
+                                   const std::vector<std::string>& parametros,
+                                   const std::vector<LinhaResultado>& linhas) {
+    if (formato == FormatoSaida::Tabela) {
+        saida << std::setw(20) << "Algoritmo";
+        for (const auto& parametro : parametros) saida << std::setw(10) << parametro;
+        saida << std::setw(15) << "Esp. Média"
+              << std::setw(15) << "Turn. Médio"
+              << std::setw(15) << "Resp. Média"
+              << std::setw(15) << "CPU %" << std::endl;
+        saida << std::string(80 + 10 * parametros.size(), '-') << std::endl;
+        
+        saida << std::fixed << std::setprecision(2);
+        for (const auto& linha : linhas) {
+            saida << std::setw(20) << linha.algoritmo;
+            for (const auto& valor : linha.valores) saida << std::setw(10) << (valor.empty() ? "-" : valor);
+            saida << std::setw(15) << linha.stats.tempoMedioEspera
+                  << std::setw(15) << linha.stats.tempoMedioTurnaround
+                  << std::setw(15) << linha.stats.tempoMedioResposta
+                  << std::setw(15) << linha.stats.utilizacaoCPU << std::endl;
+        }
+        return;
+    }
+    
+    // Todos os dígitos significativos do double, sem zeros à direita
+    saida << std::defaultfloat << std::setprecision(std::numeric_limits<double>::digits10);
+    
+    if (formato == FormatoSaida::CSV) {
+        saida << "algoritmo,";
+        for (const auto& parametro : parametros) saida << parametro << ',';
+        saida << "tempo_medio_espera,tempo_medio_turnaround,"
+              << "tempo_medio_resposta,utilizacao_cpu,throughput\n";
+    }
+    
+    for (const auto& linha : linhas) {
+        const Estatisticas& stats = linha.stats;
+        
+        if (formato == FormatoSaida::CSV) {
+            saida << linha.algoritmo << ',';
+            for (const auto& valor : linha.valores) saida << valor << ',';
+            saida << stats.tempoMedioEspera
+                  << ',' << stats.tempoMedioTurnaround
+                  << ',' << stats.tempoMedioResposta
+                  << ',' << stats.utilizacaoCPU
+                  << ',' << stats.throughput << '\n';
+        } else {
+            saida << "{\"algoritmo\":\"" << linha.algoritmo << '"';
+            for (size_t k = 0; k < parametros.size(); ++k) {
+                saida << ",\"" << parametros[k] << "\":"
+                      << (linha.valores[k].empty() ? "null" : linha.valores[k]);
+            }
+            saida << ",\"tempo_medio_espera\":" << stats.tempoMedioEspera
+                  << ",\"tempo_medio_turnaround\":" << stats.tempoMedioTurnaround
+                  << ",\"tempo_medio_resposta\":" << stats.tempoMedioResposta
+                  << ",\"utilizacao_cpu\":" << stats.utilizacaoCPU
+                  << ",\"throughput\":" << stats.throughput << "}\n";
+        }
+    }
+    
+    saida.flush();
+}
+
+void Simulador::exibirComparacao(const std::vector<std::pair<std::string, Estatisticas>>& resultados) const {
     std::cout << "\n" << std::string(80, '=') << std::endl;
     std::cout << "COMPARAÇÃO DOS ALGORITMOS" << std::endl;
     std::cout << std::string(80, '=') << std::endl;
@@ -138,6 +362,29 @@ void Simulador::executarTodosAlgoritmos() {
     }
 }
 
+void Simulador::executarEmParalelo(size_t totalTarefas, const std::function<void(size_t)>& tarefa) {
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, totalTarefas);
+    
+    // Cada thread retira a próxima tarefa livre até esgotar a lista
+    std::atomic<size_t> proxima(0);
+    auto trabalhador = [&proxima, &tarefa, totalTarefas]() {
+        for (size_t i = proxima++; i < totalTarefas; i = proxima++) {
+            tarefa(i);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) {
+        threads.emplace_back(trabalhador);
+    }
+    trabalhador(); // A thread chamadora também participa
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 void Simulador::executarAlgoritmo(const std::string& nomeAlgoritmo) {
     auto it = std::find_if(escalonadores.begin(), escalonadores.end(),
         [&nomeAlgoritmo](const std::unique_ptr<Escalonador>& esc) {
@@ -168,11 +415,12 @@ void Simulador::gerarRelatorioComparativo(const std::string& nomeArquivo) {
     
     arquivo << "PROCESSOS UTILIZADOS:\n";
     arquivo << std::string(30, '-') << "\n";
-    for (const auto& p : processosBase) {
-        arquivo << "P" << p.getPid() << " - " << p.getNome() 
-                << " (Chegada: " << p.getTempoChegada() 
-                << ", CPU: " << p.getTempoCPU() 
-                << ", Prioridade: " << p.getPrioridade() << ")\n";
+    const TabelaProcessos& tabela = carga->getTabela();
+    for (size_t i = 0; i < tabela.tamanho(); ++i) {
+        arquivo << "P" << tabela.getPid(i) << " - " << tabela.getNome(i)
+                << " (Chegada: " << tabela.getTempoChegada(i)
+                << ", CPU: " << tabela.getTempoCPU(i)
+                << ", Prioridade: " << tabela.getPrioridade(i) << ")\n";
     }
     
     arquivo << "\nRESULTADOS:\n";
@@ -208,6 +456,7 @@ void Simulador::menuInterativo() {
         std::cout << "6. Gerar relatório comparativo" << std::endl;
         std::cout << "7. Criar exemplo de processos" << std::endl;
         std::cout << "8. Limpar processos" << std::endl;
+        std::cout << "9. Executar todos os algoritmos em paralelo" << std::endl;
         std::cout << "0. Sair" << std::endl;
         std::cout << std::string(50, '-') << std::endl;
         std::cout << "Escolha uma opção: ";
@@ -277,6 +526,9 @@ void Simulador::menuInterativo() {
                 limparProcessos();
                 std::cout << "Processos removidos!" << std::endl;
                 break;
+            case 9:
+                executarTodosAlgoritmosParalelo();
+                break;
             case 0:
                 std::cout << "Saindo..." << std::endl;
                 break;
@@ -288,14 +540,12 @@ void Simulador::menuInterativo() {
 }
 
 void Simulador::limparProcessos() {
-    processosBase.clear();
-    for (auto& escalonador : escalonadores) {
-        escalonador->reiniciarSimulacao();
-    }
+    carga = std::make_shared<const CargaTrabalho>();
+    distribuirProcessos();
 }
 
 void Simulador::exibirProcessos() const {
-    if (processosBase.empty()) {
+    if (carga->vazia()) {
         std::cout << "Nenhum processo carregado." << std::endl;
         return;
     }
@@ -309,25 +559,30 @@ void Simulador::exibirProcessos() const {
               << std::setw(12) << "Prioridade" << std::endl;
     std::cout << std::string(60, '-') << std::endl;
     
-    for (const auto& p : processosBase) {
-        std::cout << std::setw(6) << p.getPid()
-                  << std::setw(12) << p.getNome()
-                  << std::setw(12) << p.getTempoChegada()
-                  << std::setw(12) << p.getTempoCPU()
-                  << std::setw(12) << p.getPrioridade() << std::endl;
+    const TabelaProcessos& tabela = carga->getTabela();
+    for (size_t i = 0; i < tabela.tamanho(); ++i) {
+        std::cout << std::setw(6) << tabela.getPid(i)
+                  << std::setw(12) << tabela.getNome(i)
+                  << std::setw(12) << tabela.getTempoChegada(i)
+                  << std::setw(12) << tabela.getTempoCPU(i)
+                  << std::setw(12) << tabela.getPrioridade(i) << std::endl;
     }
     std::cout << std::string(60, '-') << std::endl;
 }
 
 void Simulador::criarExemploProcessos() {
-    processosBase.clear();
+    TabelaProcessos tabela;
     
     // Processos com diferentes características para teste
-    processosBase.emplace_back(1, "P1", 0, 8, 2);   // Longo, prioridade média
-    processosBase.emplace_back(2, "P2", 1, 4, 1);   // Médio, alta prioridade
-    processosBase.emplace_back(3, "P3", 2, 2, 3);   // Curto, baixa prioridade
-    processosBase.emplace_back(4, "P4", 3, 6, 2);   // Longo, prioridade média
-    processosBase.emplace_back(5, "P5", 4, 1, 1);   // Muito curto, alta prioridade
+    tabela.adicionar(1, "P1", 0, 8, 2);   // Longo, prioridade média
+    tabela.adicionar(2, "P2", 1, 4, 1);   // Médio, alta prioridade
+    tabela.adicionar(3, "P3", 2, 2, 3);   // Curto, baixa prioridade
+    tabela.adicionar(4, "P4", 3, 6, 2);   // Longo, prioridade média
+    tabela.adicionar(5, "P5", 4, 1, 1);   // Muito curto, alta prioridade
+    
+    carga = std::make_shared<const CargaTrabalho>(std::move(tabela));
     
-    std::cout << "Exemplo de processos criado com 5 processos." << std::endl;
+    if (verboso) {
+        std::cout << "Exemplo de processos criado com 5 processos." << std::endl;
+    }
 }
\ No newline at end of file
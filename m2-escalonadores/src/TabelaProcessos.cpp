@@ -0,0 +1,46 @@
+#include "../include/TabelaProcessos.h"
+
+TabelaProcessos::TabelaProcessos() : inicioNomes(1, 0) {
+}
+
+void TabelaProcessos::adicionar(int pid, const std::string& nome, int tempoChegada,
+                                int tempoCPU, int prioridade) {
+    adicionar(pid, nome.data(), nome.size(), tempoChegada, tempoCPU, prioridade);
+}
+
+void TabelaProcessos::adicionar(int pid, const char* nome, size_t tamanhoNome,
+                                int tempoChegada, int tempoCPU, int prioridade) {
+    pids.push_back(pid);
+    temposChegada.push_back(tempoChegada);
+    temposCPU.push_back(tempoCPU);
+    prioridades.push_back(prioridade);
+    nomes.append(nome, tamanhoNome);
+    inicioNomes.push_back(nomes.size());
+}
+
+void TabelaProcessos::adicionar(const Processo& processo) {
+    adicionar(processo.getPid(), processo.getNome(), processo.getTempoChegada(),
+              processo.getTempoCPU(), processo.getPrioridade());
+}
+
+void TabelaProcessos::reservar(size_t n, size_t bytesNomes) {
+    pids.reserve(n);
+    temposChegada.reserve(n);
+    temposCPU.reserve(n);
+    prioridades.reserve(n);
+    inicioNomes.reserve(n + 1);
+    nomes.reserve(bytesNomes);
+}
+
+void TabelaProcessos::limpar() {
+    pids.clear();
+    temposChegada.clear();
+    temposCPU.clear();
+    prioridades.clear();
+    inicioNomes.assign(1, 0);
+    nomes.clear();
+}
+
+Processo TabelaProcessos::processo(size_t i) const {
+    return Processo(pids[i], getNome(i), temposChegada[i], temposCPU[i], prioridades[i]);
+}
@@ -0,0 +1,129 @@
+#include "../include/TraceBinario.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char TraceBinario::ASSINATURA[4] = {'E', 'S', 'C', 'B'};
+
+bool TraceBinario::ehTraceBinario(const std::string& nomeArquivo) {
+    std::ifstream arquivo(nomeArquivo, std::ios::binary);
+    char assinatura[sizeof(ASSINATURA)];
+    if (!arquivo.read(assinatura, sizeof(assinatura))) return false;
+    return std::memcmp(assinatura, ASSINATURA, sizeof(ASSINATURA)) == 0;
+}
+
+bool TraceBinario::carregar(const std::string& nomeArquivo, TabelaProcessos& tabela) {
+    int fd = open(nomeArquivo.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < sizeof(Cabecalho)) {
+        std::cerr << "Arquivo binário inválido: " << nomeArquivo << std::endl;
+        close(fd);
+        return false;
+    }
+    
+    size_t tamanho = static_cast<size_t>(info.st_size);
+    void* mapa = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // O mapeamento continua válido após fechar o descritor
+    if (mapa == MAP_FAILED) {
+        std::cerr << "Erro ao mapear arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    madvise(mapa, tamanho, MADV_SEQUENTIAL);
+    
+    const char* base = static_cast<const char*>(mapa);
+    Cabecalho cabecalho;
+    std::memcpy(&cabecalho, base, sizeof(cabecalho));
+    
+    // Validar cabeçalho e tamanhos antes de tocar nos registros
+    size_t tamanhoRegistros = cabecalho.numProcessos * sizeof(Registro);
+    bool valido = std::memcmp(cabecalho.assinatura, ASSINATURA, sizeof(ASSINATURA)) == 0 &&
+                  cabecalho.versao == VERSAO &&
+                  cabecalho.numProcessos <= (tamanho - sizeof(Cabecalho)) / sizeof(Registro) &&
+                  cabecalho.tamanhoNomes == tamanho - sizeof(Cabecalho) - tamanhoRegistros;
+    if (!valido) {
+        std::cerr << "Arquivo binário inválido: " << nomeArquivo << std::endl;
+        munmap(mapa, tamanho);
+        return false;
+    }
+    
+    const char* registros = base + sizeof(Cabecalho);
+    const char* nomes = registros + tamanhoRegistros;
+    
+    tabela.limpar();
+    tabela.reservar(cabecalho.numProcessos, cabecalho.tamanhoNomes);
+    for (uint64_t i = 0; i < cabecalho.numProcessos; ++i) {
+        Registro r;
+        std::memcpy(&r, registros + i * sizeof(Registro), sizeof(r));
+        
+        if (static_cast<uint64_t>(r.offsetNome) + r.tamanhoNome > cabecalho.tamanhoNomes) {
+            std::cerr << "Registro " << i << " com nome fora da tabela de nomes" << std::endl;
+            tabela.limpar();
+            munmap(mapa, tamanho);
+            return false;
+        }
+        
+        tabela.adicionar(r.pid, nomes + r.offsetNome, r.tamanhoNome,
+                         r.tempoChegada, r.tempoCPU, r.prioridade);
+    }
+    
+    munmap(mapa, tamanho);
+    return true;
+}
+
+bool TraceBinario::salvar(const std::string& nomeArquivo, const TabelaProcessos& tabela) {
+    // Montar registros e tabela de nomes em memória e gravar em três blocos
+    std::vector<Registro> registros;
+    std::string nomes;
+    registros.reserve(tabela.tamanho());
+    for (size_t i = 0; i < tabela.tamanho(); ++i) {
+        std::string nome = tabela.getNome(i);
+        Registro r;
+        r.pid = tabela.getPid(i);
+        r.tempoChegada = tabela.getTempoChegada(i);
+        r.tempoCPU = tabela.getTempoCPU(i);
+        r.prioridade = tabela.getPrioridade(i);
+        r.offsetNome = static_cast<uint32_t>(nomes.size());
+        r.tamanhoNome = static_cast<uint32_t>(nome.size());
+        registros.push_back(r);
+        nomes += nome;
+    }
+    
+    if (nomes.size() > UINT32_MAX) {
+        std::cerr << "Tabela de nomes excede o limite do formato (4 GiB)" << std::endl;
+        return false;
+    }
+    
+    // Só depois de validar: o trunc apagaria o arquivo existente
+    std::ofstream arquivo(nomeArquivo, std::ios::binary | std::ios::trunc);
+    if (!arquivo.is_open()) {
+        std::cerr << "Erro ao criar arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    
+    Cabecalho cabecalho;
+    std::memcpy(cabecalho.assinatura, ASSINATURA, sizeof(ASSINATURA));
+    cabecalho.versao = VERSAO;
+    cabecalho.numProcessos = registros.size();
+    cabecalho.tamanhoNomes = nomes.size();
+    
+    arquivo.write(reinterpret_cast<const char*>(&cabecalho), sizeof(cabecalho));
+    arquivo.write(reinterpret_cast<const char*>(registros.data()),
+                  static_cast<std::streamsize>(registros.size() * sizeof(Registro)));
+    arquivo.write(nomes.data(), static_cast<std::streamsize>(nomes.size()));
+    
+    if (!arquivo) {
+        std::cerr << "Erro ao gravar arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    return true;
+}
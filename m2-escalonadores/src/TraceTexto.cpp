@@ -0,0 +1,130 @@
+#include "../include/TraceTexto.h"
+#include <iostream>
+#include <cstdio>
+#include <climits>
+#include <algorithm>
+
+// Espaço em branco dentro de uma linha ('\r' cobre arquivos com CRLF)
+static bool ehEspaco(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static void pularEspacos(const char*& p, const char* fim) {
+    while (p < fim && ehEspaco(*p)) ++p;
+}
+
+// Lê um inteiro com sinal opcional, no estilo de std::from_chars; o número
+// deve terminar em espaço ou no fim da linha
+static bool lerInteiro(const char*& p, const char* fim, int& valor) {
+    const char* q = p;
+    bool negativo = false;
+    if (q < fim && (*q == '-' || *q == '+')) {
+        negativo = (*q == '-');
+        ++q;
+    }
+    if (q == fim || *q < '0' || *q > '9') return false;
+    
+    long long acumulado = 0;
+    while (q < fim && *q >= '0' && *q <= '9') {
+        acumulado = acumulado * 10 + (*q - '0');
+        if (acumulado > static_cast<long long>(INT_MAX) + 1) return false;
+        ++q;
+    }
+    if (q < fim && !ehEspaco(*q)) return false;
+    
+    if (negativo) acumulado = -acumulado;
+    if (acumulado > INT_MAX || acumulado < INT_MIN) return false;
+    
+    valor = static_cast<int>(acumulado);
+    p = q;
+    return true;
+}
+
+// Lê uma palavra (sequência sem espaços), sem copiá-la
+static bool lerPalavra(const char*& p, const char* fim, const char*& palavra, size_t& tamanho) {
+    palavra = p;
+    while (p < fim && !ehEspaco(*p)) ++p;
+    tamanho = static_cast<size_t>(p - palavra);
+    return tamanho > 0;
+}
+
+// Analisa uma linha de dados: PID Nome TempoChegada TempoCPU [Prioridade]
+static bool analisarLinha(const char* p, const char* fim, TabelaProcessos& tabela) {
+    int pid, tempoChegada, tempoCPU, prioridade = 0;
+    const char* nome;
+    size_t tamanhoNome;
+    
+    if (!lerInteiro(p, fim, pid)) return false;
+    pularEspacos(p, fim);
+    if (!lerPalavra(p, fim, nome, tamanhoNome)) return false;
+    pularEspacos(p, fim);
+    if (!lerInteiro(p, fim, tempoChegada)) return false;
+    pularEspacos(p, fim);
+    if (!lerInteiro(p, fim, tempoCPU)) return false;
+    pularEspacos(p, fim);
+    if (p < fim && !lerInteiro(p, fim, prioridade)) return false; // Prioridade é opcional
+    
+    tabela.adicionar(pid, nome, tamanhoNome, tempoChegada, tempoCPU, prioridade);
+    return true;
+}
+
+static bool contemLetra(const char* p, const char* fim) {
+    for (; p < fim; ++p) {
+        if ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) return true;
+    }
+    return false;
+}
+
+bool TraceTexto::carregar(const std::string& nomeArquivo, TabelaProcessos& tabela) {
+    FILE* arquivo = std::fopen(nomeArquivo.c_str(), "rb");
+    if (arquivo == nullptr) {
+        std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    
+    // Ler o arquivo inteiro de uma vez, reservando o tamanho quando conhecido
+    std::string conteudo;
+    if (std::fseek(arquivo, 0, SEEK_END) == 0) {
+        long tamanho = std::ftell(arquivo);
+        if (tamanho > 0) conteudo.reserve(static_cast<size_t>(tamanho));
+        std::rewind(arquivo);
+    }
+    
+    char bloco[1 << 16];
+    size_t lidos;
+    while ((lidos = std::fread(bloco, 1, sizeof(bloco), arquivo)) > 0) {
+        conteudo.append(bloco, lidos);
+    }
+    std::fclose(arquivo);
+    
+    tabela.limpar();
+    const char* p = conteudo.data();
+    const char* fimArquivo = p + conteudo.size();
+    tabela.reservar(std::count(p, fimArquivo, '\n') + 1);
+    int numeroLinha = 0;
+    
+    while (p < fimArquivo) {
+        const char* fimLinha = p;
+        while (fimLinha < fimArquivo && *fimLinha != '\n') ++fimLinha;
+        numeroLinha++;
+        
+        const char* inicioLinha = p;
+        p = fimLinha + (fimLinha < fimArquivo ? 1 : 0);
+        
+        // Se a primeira linha contém letras, é provável que seja cabeçalho
+        if (numeroLinha == 1 && contemLetra(inicioLinha, fimLinha)) continue;
+        
+        const char* c = inicioLinha;
+        pularEspacos(c, fimLinha);
+        if (c == fimLinha || *c == '#') continue; // Pular linhas vazias e comentários
+        
+        if (!analisarLinha(c, fimLinha, tabela)) {
+            const char* fimTexto = fimLinha;
+            if (fimTexto > inicioLinha && fimTexto[-1] == '\r') --fimTexto;
+            std::cerr << "Erro na linha " << numeroLinha << ": "
+                      << std::string(inicioLinha, fimTexto) << std::endl;
+        }
+    }
+    
+    return true;
+}